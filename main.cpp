@@ -1,5 +1,6 @@
 #include "my_lib/game/game.h"
 #include "my_lib/graph/GraphAsMatrix.h"
+#include "my_lib/graph/Parallel.h"
 #include "include/SDL2/SDL.h"
 #include "include/SDL2/SDL_image.h"
 
@@ -308,6 +309,8 @@ bool isInCycle(const std::vector<std::vector<int>>& cycles, std::vector<bool>& c
 int main(int argc, char* args[]) {
 
     srand(static_cast<unsigned int>(time(nullptr)));
+    // jeden rdzeń zostaje dla renderowania, reszta dla algorytmów grafowych
+    ThreadPool::configure(hardware_thread_count() - 1);
 
     if (!InitSDL()) {
         SDL_Log("Nie można zainicjować SDL");
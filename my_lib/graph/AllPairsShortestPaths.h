@@ -0,0 +1,313 @@
+#ifndef ALL_PAIRS_SHORTEST_PATHS_H
+#define ALL_PAIRS_SHORTEST_PATHS_H
+
+#include "../../include/SDL2/SDL_cpuinfo.h"
+#include "Graph.h"
+#include "GraphConcept.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ALL_PAIRS_SHORTEST_PATHS_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ALL_PAIRS_SHORTEST_PATHS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ALL_PAIRS_SHORTEST_PATHS_TARGET(isa)
+#endif
+
+/**
+ * @brief All-pairs shortest paths (Floyd-Warshall) over the edge weights, negative ones included.
+ * @note The weights are copied into a dense n x n matrix of ints (rows padded to a multiple of
+ * @note BLOCK) and relaxed in BLOCK x BLOCK blocks: for every k-th diagonal block, first the block
+ * @note itself, then its row and column of blocks, then all other blocks - the last two phases
+ * @note in parallel. A block of 64 x 64 ints is 16 KB, so the three blocks of an update stay in L1/L2,
+ * @note and the inner loop over j runs 8 ints at a time with AVX2 when the processor has it.
+ * @note With paths, a matrix of successors (the next vertex on the path i -> j) is built after
+ * @note the distances, by a BFS from every target j backwards over the tight edges
+ * @note (w(u, v) + d[v][j] = d[u][j]), O(n * m) in parallel. Every successor is one BFS level
+ * @note closer to j, so a path always ends, also through cycles of weight 0. This doubles memory.
+ * @note Distances must stay below INFINITE / 2; a negative cycle makes the results meaningless,
+ * @note has_negative_cycle() tells whether there is one.
+ */
+class AllPairsShortestPaths {
+    public:
+        enum class Kernel { SCALAR, AVX2 };
+
+        static constexpr int INFINITE = INT_MAX / 2;  //* distance of an unreachable vertex
+        static constexpr int BLOCK = 64;
+
+        AllPairsShortestPaths(bool with_paths = false, int threads = default_thread_count(), Kernel kernel = detect_kernel())
+            : with_paths(with_paths), threads(threads), kernel(kernel) {}
+
+        static Kernel detect_kernel();
+
+        template<OutNeighborGraph G>
+        void run(const G& graph);
+        void run(const Graph& graph) { run(VirtualGraph(graph));}
+
+        int get_number_of_vertices() const { return n;}
+        int distance(int v_outgoing, int v_incoming) const { return dist[cell(v_outgoing, v_incoming)];}
+        bool reachable(int v_outgoing, int v_incoming) const { return distance(v_outgoing, v_incoming) != INFINITE;}
+        bool has_negative_cycle() const;
+
+        //! zwraca wierzchołki najkrótszej ścieżki (z oboma końcami), pustą gdy jej nie ma albo run bez ścieżek
+        std::vector<int> path(int v_outgoing, int v_incoming) const;
+
+    private:
+        bool with_paths;
+        int threads;
+        Kernel kernel;
+        int n = 0;
+        int stride = 0;            // długość wiersza z dopełnieniem do wielokrotności BLOCK
+        std::vector<int> dist;
+        std::vector<int> next;     // następny wierzchołek na ścieżce albo -1
+
+        size_t cell(int row, int column) const { return static_cast<size_t>(row) * stride + column;}
+
+        //* relaxes block (bi, bj) through the vertices of block bk
+        void relax(int bi, int bj, int bk);
+        void relax_scalar(int *c, const int *a, const int *b) const;
+#ifdef ALL_PAIRS_SHORTEST_PATHS_X86
+        void relax_avx2(int *c, const int *a, const int *b) const;
+        void relax_independent_avx2(int *c, const int *a, const int *b) const;
+#endif
+        template<OutNeighborGraph G>
+        void build_successors(const G& graph);
+};
+
+AllPairsShortestPaths::Kernel AllPairsShortestPaths::detect_kernel() {
+#ifdef ALL_PAIRS_SHORTEST_PATHS_X86
+    if (SDL_HasAVX2()) return Kernel::AVX2;
+#endif
+    return Kernel::SCALAR;
+}
+
+template<OutNeighborGraph G>
+void AllPairsShortestPaths::run(const G& graph) {
+    n = graph.get_number_of_vertices();
+    stride = (n + BLOCK - 1) / BLOCK * BLOCK;
+    const size_t cells = static_cast<size_t>(stride) * stride;
+    dist.assign(cells, INFINITE);
+    next.clear();
+
+    for (int v = 0; v < stride; v++) dist[cell(v, v)] = 0;
+    for (int v = 0; v < n; v++) {
+        graph.for_each_out_neighbor(v, [this, v](int v_incoming, int weight) {
+            const size_t c = cell(v, v_incoming);
+            dist[c] = std::min(dist[c], weight);
+        });
+    }
+
+    const int blocks = stride / BLOCK;
+    for (int bk = 0; bk < blocks; bk++) {
+        relax(bk, bk, bk);
+        //* blocks [0, blocks) are the row of bk, [blocks, 2 * blocks) its column
+        parallel_for(0, 2 * blocks, [this, bk, blocks](int b) {
+            if (b % blocks == bk) return;
+            if (b < blocks) {
+                relax(bk, b, bk);
+            } else {
+                relax(b - blocks, bk, bk);
+            }
+        }, threads);
+        parallel_for(0, blocks, [this, bk, blocks](int bi) {
+            if (bi == bk) return;
+            for (int bj = 0; bj < blocks; bj++) {
+                if (bj != bk) relax(bi, bj, bk);
+            }
+        }, threads);
+    }
+
+    if (with_paths) build_successors(graph);
+}
+
+/**
+ * @brief next[u][j] for every target j: a BFS from j over the reversed tight edges, the
+ * successor of u is the vertex that discovered it. Targets are handed out in chunks, each
+ * with its own queue.
+ */
+template<OutNeighborGraph G>
+void AllPairsShortestPaths::build_successors(const G& graph) {
+    constexpr int TARGETS_PER_CHUNK = 16;
+    next.assign(static_cast<size_t>(stride) * stride, -1);
+
+    //* reversed edges, without self-loops (a vertex is its own successor anyway)
+    std::vector<int> in_offsets(n + 1, 0);
+    for (int v = 0; v < n; v++) {
+        graph.for_each_out_neighbor(v, [&](int v_incoming, int) { if (v_incoming != v) in_offsets[v_incoming + 1]++;});
+    }
+    for (int v = 0; v < n; v++) in_offsets[v + 1] += in_offsets[v];
+    std::vector<int> in_sources(in_offsets[n]), in_weights(in_offsets[n]);
+    {
+        std::vector<int> fill(in_offsets.begin(), in_offsets.end() - 1);
+        for (int v = 0; v < n; v++) {
+            graph.for_each_out_neighbor(v, [&](int v_incoming, int weight) {
+                if (v_incoming == v) return;
+                in_sources[fill[v_incoming]] = v;
+                in_weights[fill[v_incoming]++] = weight;
+            });
+        }
+    }
+
+    const int chunks = (n + TARGETS_PER_CHUNK - 1) / TARGETS_PER_CHUNK;
+    parallel_for(0, chunks, [&](int chunk) {
+        std::vector<int> queue;
+        queue.reserve(n);
+        std::vector<int> seen(n, -1);   // cel, dla którego wierzchołek już ma następnika
+        const int last = std::min(n, (chunk + 1) * TARGETS_PER_CHUNK);
+        for (int target = chunk * TARGETS_PER_CHUNK; target < last; target++) {
+            next[cell(target, target)] = target;
+            seen[target] = target;
+            queue.assign(1, target);
+            for (size_t head = 0; head < queue.size(); head++) {
+                const int v = queue[head];
+                const long long through = dist[cell(v, target)];
+                for (int e = in_offsets[v]; e < in_offsets[v + 1]; e++) {
+                    const int u = in_sources[e];
+                    if (seen[u] == target || dist[cell(u, target)] == INFINITE) continue;
+                    if (through + in_weights[e] != dist[cell(u, target)]) continue;
+                    seen[u] = target;
+                    next[cell(u, target)] = v;
+                    queue.push_back(u);
+                }
+            }
+        }
+    }, threads);
+}
+
+void AllPairsShortestPaths::relax(int bi, int bj, int bk) {
+    const size_t c = cell(bi * BLOCK, bj * BLOCK);
+    const size_t a = cell(bi * BLOCK, bk * BLOCK);
+    const size_t b = cell(bk * BLOCK, bj * BLOCK);
+
+#ifdef ALL_PAIRS_SHORTEST_PATHS_X86
+    if (kernel == Kernel::AVX2 && bi != bk && bj != bk) {
+        relax_independent_avx2(dist.data() + c, dist.data() + a, dist.data() + b);
+        return;
+    }
+    if (kernel == Kernel::AVX2) {
+        relax_avx2(dist.data() + c, dist.data() + a, dist.data() + b);
+        return;
+    }
+#endif
+    relax_scalar(dist.data() + c, dist.data() + a, dist.data() + b);
+}
+
+/**
+ * @brief c[i][j] = min(c[i][j], a[i][k] + b[k][j]) for the k of one block, in place.
+ * @note c may be a or b (the diagonal phases): a row k or column k of the block never
+ * @note improves through k itself, since d[k][k] = 0.
+ * @note Rows with a[i][k] = INFINITE are skipped, and INFINITE in b must not turn into
+ * @note a finite sum when a[i][k] is negative, hence the second test.
+ */
+void AllPairsShortestPaths::relax_scalar(int *c, const int *a, const int *b) const {
+    for (int k = 0; k < BLOCK; k++) {
+        const int *b_row = b + static_cast<size_t>(k) * stride;
+        for (int i = 0; i < BLOCK; i++) {
+            const int through = a[static_cast<size_t>(i) * stride + k];
+            if (through == INFINITE) continue;
+
+            int *c_row = c + static_cast<size_t>(i) * stride;
+            for (int j = 0; j < BLOCK; j++) {
+                const int candidate = (b_row[j] == INFINITE) ? INFINITE : through + b_row[j];
+                c_row[j] = std::min(c_row[j], candidate);
+            }
+        }
+    }
+}
+
+#ifdef ALL_PAIRS_SHORTEST_PATHS_X86
+ALL_PAIRS_SHORTEST_PATHS_TARGET("avx2")
+void AllPairsShortestPaths::relax_avx2(int *c, const int *a, const int *b) const {
+    const __m256i infinite = _mm256_set1_epi32(INFINITE);
+    for (int k = 0; k < BLOCK; k++) {
+        const int *b_row = b + static_cast<size_t>(k) * stride;
+        for (int i = 0; i < BLOCK; i++) {
+            const int through = a[static_cast<size_t>(i) * stride + k];
+            if (through == INFINITE) continue;
+
+            const __m256i through8 = _mm256_set1_epi32(through);
+            int *c_row = c + static_cast<size_t>(i) * stride;
+            for (int j = 0; j < BLOCK; j += 8) {
+                const __m256i b8 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b_row + j));
+                const __m256i c8 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c_row + j));
+                const __m256i candidate = _mm256_blendv_epi8(_mm256_add_epi32(through8, b8), infinite, _mm256_cmpeq_epi32(b8, infinite));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(c_row + j), _mm256_min_epi32(c8, candidate));
+            }
+        }
+    }
+}
+
+/**
+ * @brief relax_avx2 for c different from a and b (the third phase, nearly all the work): the order
+ * of k and i does not matter then, so 32 columns of a row of c stay in registers
+ * through all 64 values of k and every update costs one load of b.
+ */
+ALL_PAIRS_SHORTEST_PATHS_TARGET("avx2")
+void AllPairsShortestPaths::relax_independent_avx2(int *c, const int *a, const int *b) const {
+    constexpr int VECTORS = 4;
+    const __m256i infinite = _mm256_set1_epi32(INFINITE);
+    for (int i = 0; i < BLOCK; i++) {
+        const int *a_row = a + static_cast<size_t>(i) * stride;
+        int *c_row = c + static_cast<size_t>(i) * stride;
+
+        for (int j = 0; j < BLOCK; j += 8 * VECTORS) {
+            __m256i c8[VECTORS];
+            for (int v = 0; v < VECTORS; v++) c8[v] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c_row + j + 8 * v));
+
+            for (int k = 0; k < BLOCK; k++) {
+                if (a_row[k] == INFINITE) continue;
+                const __m256i through8 = _mm256_set1_epi32(a_row[k]);
+                const int *b_row = b + static_cast<size_t>(k) * stride + j;
+                for (int v = 0; v < VECTORS; v++) {
+                    const __m256i b8 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b_row + 8 * v));
+                    const __m256i candidate = _mm256_blendv_epi8(_mm256_add_epi32(through8, b8), infinite, _mm256_cmpeq_epi32(b8, infinite));
+                    c8[v] = _mm256_min_epi32(c8[v], candidate);
+                }
+            }
+
+            for (int v = 0; v < VECTORS; v++) _mm256_storeu_si256(reinterpret_cast<__m256i*>(c_row + j + 8 * v), c8[v]);
+        }
+    }
+}
+#endif
+
+bool AllPairsShortestPaths::has_negative_cycle() const {
+    for (int v = 0; v < n; v++) {
+        if (dist[cell(v, v)] < 0) return true;
+    }
+    return false;
+}
+
+std::vector<int> AllPairsShortestPaths::path(int v_outgoing, int v_incoming) const {
+    std::vector<int> vertices;
+    if (next.empty() || next[cell(v_outgoing, v_incoming)] == -1) return vertices;
+
+    vertices.push_back(v_outgoing);
+    for (int v = v_outgoing; v != v_incoming;) {
+        v = next[cell(v, v_incoming)];
+        //* only possible with a negative cycle: no walk instead of a wrong one
+        if (v == -1 || static_cast<int>(vertices.size()) == n) return {};
+        vertices.push_back(v);
+    }
+    return vertices;
+}
+
+//! odległości między wszystkimi parami wierzchołków, patrz AllPairsShortestPaths
+template<OutNeighborGraph G>
+AllPairsShortestPaths all_pairs_shortest_paths(const G& graph, bool with_paths = false) {
+    AllPairsShortestPaths result(with_paths);
+    result.run(graph);
+    return result;
+}
+
+AllPairsShortestPaths all_pairs_shortest_paths(const Graph& graph, bool with_paths = false) {
+    return all_pairs_shortest_paths(VirtualGraph(graph), with_paths);
+}
+#endif
@@ -0,0 +1,183 @@
+#ifndef BANK_BREAKING_H
+#define BANK_BREAKING_H
+
+#include "Graph.h"
+#include "GraphConcept.h"
+#include "Condensation.h"
+#include <vector>
+
+/**
+ * @brief Minimum-cost bank breaking. An edge u -> v means the key of bank v lies in bank u:
+ * breaking u opens v and everything reachable from it. Every bank has to end up open.
+ * @note A bank can only be opened from inside its strongly connected component or from
+ * @note a component with an edge into it, so exactly the source components of the
+ * @note condensation need a broken bank, and the cheapest one of each is the optimum.
+ * @note When no bank has more than one key (in-degree <= 1) the graph is functional: its source
+ * @note components are its cycles and the banks without a key, found by one walk along the
+ * @note key holders.
+ * @note Results are streamed: emit(bank, cost) is called once per chosen bank, nothing is kept.
+ */
+struct BankBreaking {
+    long long cost = 0;             //* total cost of the chosen banks
+    std::vector<int> banks;         //* banks to break, one per source component
+    bool functional = false;        //* whether no bank had more than one key
+};
+
+/**
+ * @brief Functional case: holder[v] is the bank with the key of v, -1 when v has no key.
+ * Calls emit(bank, cost(bank)) for every bank without a key and the cheapest bank of every
+ * cycle, and returns the total cost, O(n).
+ * @note Every vertex is entered once: a walk goes along holders until it meets a visited
+ * @note vertex, and if that vertex belongs to the same walk, the walk has closed a cycle.
+ */
+template<typename Cost, typename Emit>
+long long break_functional_banks(const std::vector<int>& holder, Cost&& cost, Emit&& emit) {
+    const int n = static_cast<int>(holder.size());
+    std::vector<int> walk(n, -1);   // wierzchołek startowy przejścia, które odwiedziło bank
+    long long total = 0;
+
+    for (int start = 0; start < n; start++) {
+        if (holder[start] == -1) {
+            const long long price = cost(start);
+            total += price;
+            emit(start, price);
+        }
+
+        int v = start;
+        while (v >= 0 && walk[v] == -1) {
+            walk[v] = start;
+            v = holder[v];
+        }
+        if (v < 0 || walk[v] != start) continue;
+
+        //* v lies on a new cycle
+        int cheapest = v;
+        long long best = cost(v);
+        for (int u = holder[v]; u != v; u = holder[u]) {
+            const long long price = cost(u);
+            if (price < best) {
+                best = price;
+                cheapest = u;
+            }
+        }
+        total += best;
+        emit(cheapest, best);
+    }
+    return total;
+}
+
+/**
+ * @brief The cheapest bank of every source component of a condensation, by cost(bank); the
+ * sources are its first topological level, so this costs O(size of the source components).
+ */
+template<typename Cost, typename Emit>
+long long break_banks(const Condensation& condensation, Cost&& cost, Emit&& emit) {
+    const std::vector<int>& order = condensation.get_order();
+    const int sources = condensation.get_number_of_levels() > 0 ? condensation.get_level_offsets()[1] : 0;
+    long long total = 0;
+    for (int i = 0; i < sources; i++) {
+        int cheapest = -1;
+        long long best = 0;
+        condensation.for_each_member(order[i], [&](int v) {
+            const long long price = cost(v);
+            if (cheapest == -1 || price < best) {
+                cheapest = v;
+                best = price;
+            }
+        });
+        total += best;
+        emit(cheapest, best);
+    }
+    return total;
+}
+
+/**
+ * @brief Any graph: the cheapest bank of every source component, by cost(bank). Uses
+ * break_functional_banks when no in-degree exceeds 1, the condensation otherwise; O(n + m).
+ */
+template<OutNeighborGraph G, typename Cost, typename Emit>
+long long break_banks(const G& graph, Cost&& cost, Emit&& emit, bool *functional = nullptr) {
+    const int n = graph.get_number_of_vertices();
+    std::vector<int> holder(n, -1);
+    bool single_keys = true;
+    for (int u = 0; u < n; u++) {
+        graph.for_each_out_neighbor(u, [&](int v_incoming, int) {
+            if (holder[v_incoming] != -1) single_keys = false;
+            holder[v_incoming] = u;
+        });
+    }
+    if (functional) *functional = single_keys;
+    if (single_keys) return break_functional_banks(holder, cost, emit);
+    holder = std::vector<int>();
+
+    return break_banks(condense(graph), cost, emit);
+}
+
+//! cena rozbicia banku v: największa waga krawędzi do v (krawędzi z jego kluczem), 0 bez kluczy
+template<OutNeighborGraph G>
+std::vector<long long> breaking_costs(const G& graph) {
+    std::vector<long long> cost(graph.get_number_of_vertices(), 0);
+    std::vector<char> priced(cost.size(), 0);
+    for (int u = 0; u < graph.get_number_of_vertices(); u++) {
+        graph.for_each_out_neighbor(u, [&](int v_incoming, int weight) {
+            if (!priced[v_incoming] || weight > cost[v_incoming]) cost[v_incoming] = weight;
+            priced[v_incoming] = 1;
+        });
+    }
+    return cost;
+}
+
+std::vector<long long> breaking_costs(const Graph& graph) {
+    return breaking_costs(VirtualGraph(graph));
+}
+
+//! najtańszy zbiór banków do rozbicia, ceny z breaking_costs (wagi krawędzi)
+template<OutNeighborGraph G>
+BankBreaking cheapest_banks_to_break(const G& graph) {
+    const std::vector<long long> cost = breaking_costs(graph);
+    BankBreaking result;
+    result.cost = break_banks(graph, [&cost](int v) { return cost[v];},
+            [&result](int bank, long long) { result.banks.push_back(bank);}, &result.functional);
+    return result;
+}
+
+BankBreaking cheapest_banks_to_break(const Graph& graph) {
+    return cheapest_banks_to_break(VirtualGraph(graph));
+}
+
+//* one step of the opening order
+struct OpeningStep {
+    int bank;
+    int opened_by;      //* bank that held its key, -1 for a broken bank
+};
+
+/**
+ * @brief Order in which the banks open after the banks in broken are broken: a BFS from all of
+ * them at once, every bank opened with the key from a bank opened before it. O(n + m).
+ * @note Banks that stay closed are left out, so a short result means broken was not enough.
+ */
+template<OutNeighborGraph G>
+std::vector<OpeningStep> opening_order(const G& graph, const std::vector<int>& broken) {
+    std::vector<char> open(graph.get_number_of_vertices(), 0);
+    std::vector<OpeningStep> steps;
+    steps.reserve(open.size());
+    for (int bank : broken) {
+        if (open[bank]) continue;
+        open[bank] = 1;
+        steps.push_back({bank, -1});
+    }
+    for (size_t head = 0; head < steps.size(); head++) {
+        const int bank = steps[head].bank;
+        graph.for_each_out_neighbor(bank, [&](int v_incoming, int) {
+            if (open[v_incoming]) return;
+            open[v_incoming] = 1;
+            steps.push_back({v_incoming, bank});
+        });
+    }
+    return steps;
+}
+
+std::vector<OpeningStep> opening_order(const Graph& graph, const std::vector<int>& broken) {
+    return opening_order(VirtualGraph(graph), broken);
+}
+#endif
@@ -0,0 +1,97 @@
+#ifndef BUFFERED_WRITER_H
+#define BUFFERED_WRITER_H
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Output sink that collects text in a fixed-size buffer and hands it to
+ * the C stream in large fwrite() calls instead of one call per token.
+ * @note The writer either borrows a stream (e.g. stdout) or owns a file it opened itself.
+ */
+class BufferedWriter {
+    public:
+        BufferedWriter(std::FILE *stream, size_t capacity = 1 << 16)
+            : stream(stream), buffer(capacity < 64 ? 64 : capacity) {}
+
+        BufferedWriter(const std::string& filename, bool append, size_t capacity = 1 << 16)
+            : stream(std::fopen(filename.c_str(), append ? "ab" : "wb")), owns_stream(true),
+              buffer(capacity < 64 ? 64 : capacity) {}
+
+        BufferedWriter(const BufferedWriter&) = delete;
+        BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+        ~BufferedWriter() { close();}
+
+        bool is_open() const { return stream != nullptr;}
+
+        void put(char c) {
+            if (used == buffer.size()) flush();
+            buffer[used++] = c;
+        }
+
+        void write(const char *data, size_t size) {
+            if (size > buffer.size() - used) {
+                flush();
+                //* bigger than the whole buffer - there is no point in copying it
+                if (size >= buffer.size()) {
+                    if (stream) std::fwrite(data, 1, size, stream);
+                    return;
+                }
+            }
+            std::memcpy(buffer.data() + used, data, size);
+            used += size;
+        }
+
+        void write(const char *text) { write(text, std::strlen(text));}
+        void write(const std::string& text) { write(text.data(), text.size());}
+
+        void write_int(long long value) {
+            if (value < 0) {
+                put('-');
+                write_uint(0ULL - static_cast<unsigned long long>(value));
+            } else {
+                write_uint(static_cast<unsigned long long>(value));
+            }
+        }
+
+        void write_uint(unsigned long long value) {
+            char digits[20];
+            int length = 0;
+            do {
+                digits[length++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value);
+
+            if (length > static_cast<int>(buffer.size() - used)) flush();
+            while (length) buffer[used++] = digits[--length];
+        }
+
+        //! wypisuje podaną liczbę spacji (odpowiednik std::setw dla pustego napisu)
+        void pad(int count) {
+            for (; count > 0; count--) put(' ');
+        }
+
+        void flush() {
+            if (stream && used) std::fwrite(buffer.data(), 1, used, stream);
+            used = 0;
+        }
+
+        void close() {
+            flush();
+            if (stream) {
+                if (owns_stream) std::fclose(stream);
+                else std::fflush(stream);
+            }
+            stream = nullptr;
+        }
+
+    private:
+        std::FILE *stream = nullptr;
+        bool owns_stream = false;
+        std::vector<char> buffer;
+        size_t used = 0;
+};
+#endif
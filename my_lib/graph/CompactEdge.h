@@ -0,0 +1,35 @@
+#ifndef COMPACT_EDGE_H
+#define COMPACT_EDGE_H
+
+#include <cstdint>
+
+/**
+ * @brief Weight type of unweighted graphs: holds nothing, reads as 0.
+ */
+struct NoWeight {
+    constexpr NoWeight() {}
+    constexpr NoWeight(int) {}
+    constexpr operator int() const { return 0;}
+};
+
+/**
+ * @brief Edge stored by value inside an adjacency row: the index of the target vertex and the weight.
+ * @note The source vertex is the row the edge lives in, so it is not stored. With W = NoWeight
+ * @note the weight takes no space ([[no_unique_address]]) and an edge is one int32, compared to
+ * @note two Vertex* and an int (24 bytes) plus a heap allocation for every Edge object.
+ * @note Edge remains the API type; backends create Edge views of compact edges on request.
+ */
+template<typename W>
+struct CompactEdge {
+    int32_t target = -1;
+    [[no_unique_address]] W weight{};
+
+    CompactEdge() = default;
+    CompactEdge(int target, W weight) : target(target), weight(weight) {}
+
+    int get_weight() const { return static_cast<int>(weight);}
+};
+
+static_assert(sizeof(CompactEdge<NoWeight>) == sizeof(int32_t), "unweighted edge has to be a single index");
+static_assert(sizeof(CompactEdge<int>) == 2 * sizeof(int32_t), "weighted edge has to be two ints");
+#endif
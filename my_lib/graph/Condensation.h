@@ -0,0 +1,268 @@
+#ifndef CONDENSATION_H
+#define CONDENSATION_H
+
+#include "Graph.h"
+#include "GraphConcept.h"
+#include "StronglyConnected.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The condensation of a graph (one vertex per strongly connected component) as a read-only
+ * CSR backend: it is an InNeighborGraph, so every template algorithm runs on the DAG directly.
+ * @note Vertices are Tarjan component ids (an edge goes from a higher id to a lower one), the
+ * @note edges u -> v of the graph between two components become one edge whose weight is the
+ * @note number of merged edges. Rows are sorted by id, in both directions.
+ * @note Everything is built in O(n + m): Tarjan, then two counting sorts instead of sorting rows.
+ * @note The topological order comes from Kahn's algorithm run level by level: level l holds the
+ * @note components whose longest path from a source has l edges, so no edge joins two components
+ * @note of one level and a level can be processed in parallel. With threads > 1 big levels are
+ * @note split between threads (atomic in-degrees), and the order inside a level is then arbitrary.
+ */
+class Condensation {
+    public:
+        Condensation() = default;
+
+        template<OutNeighborGraph G>
+        void build(const G& graph, int threads = 1);
+        void build(const Graph& graph, int threads = 1) { build(VirtualGraph(graph), threads);}
+
+        int get_number_of_vertices() const { return scc.count;}
+        int get_number_of_edges() const { return static_cast<int>(successors.size());}
+
+        template<typename Function>
+        void for_each_out_neighbor(const int component, Function&& function) const {
+            for (int i = offsets[component]; i < offsets[component + 1]; i++) function(successors[i], multiplicity[i]);
+        }
+
+        template<typename Function>
+        void for_each_in_neighbor(const int component, Function&& function) const {
+            for (int i = in_offsets[component]; i < in_offsets[component + 1]; i++) function(predecessors[i], in_multiplicity[i]);
+        }
+
+        int out_degree(const int component) const { return offsets[component + 1] - offsets[component];}
+        int in_degree(const int component) const { return in_offsets[component + 1] - in_offsets[component];}
+
+        //! komponent zawierający wierzchołek v grafu
+        int component_of(const int v) const { return scc.component[v];}
+        int get_size(const int component) const { return member_offsets[component + 1] - member_offsets[component];}
+
+        //! wywołuje function(v) dla każdego wierzchołka grafu w komponencie
+        template<typename Function>
+        void for_each_member(const int component, Function&& function) const {
+            for (int i = member_offsets[component]; i < member_offsets[component + 1]; i++) function(members[i]);
+        }
+
+        //* components in topological order, sources first, level after level
+        const std::vector<int>& get_order() const { return order;}
+        //* level l is get_order()[level_offsets[l] .. level_offsets[l + 1])
+        const std::vector<int>& get_level_offsets() const { return level_offsets;}
+        int get_number_of_levels() const { return static_cast<int>(level_offsets.size()) - 1;}
+        int get_level(const int component) const { return level[component];}
+
+        const SccResult& get_components() const { return scc;}
+        const std::vector<int>& get_offsets() const { return offsets;}
+        const std::vector<int>& get_successors() const { return successors;}
+
+        //! przenosi komponenty i krawędzie wychodzące do podanych wektorów, kondensacja zostaje pusta
+        void release(SccResult& components, std::vector<int>& out_offsets, std::vector<int>& out_successors);
+
+        size_t memory_usage() const;
+
+    private:
+        static constexpr int SERIAL_LEVEL = 1024;  // mniejsze poziomy przetwarza jeden wątek
+        static constexpr int LEVEL_CHUNK = 256;
+
+        SccResult scc;
+        std::vector<int> offsets;
+        std::vector<int> successors;
+        std::vector<int> multiplicity;
+        std::vector<int> in_offsets;
+        std::vector<int> predecessors;
+        std::vector<int> in_multiplicity;
+        std::vector<int> member_offsets;
+        std::vector<int> members;
+        std::vector<int> order;
+        std::vector<int> level_offsets;
+        std::vector<int> level;
+
+        void sort_levels(int threads);
+};
+
+template<OutNeighborGraph G>
+void Condensation::build(const G& graph, int threads) {
+    scc = strongly_connected_components(graph);
+    const int n = graph.get_number_of_vertices();
+    const int count = scc.count;
+
+    //* members grouped by component, a counting sort
+    member_offsets.assign(count + 1, 0);
+    for (int v = 0; v < n; v++) member_offsets[scc.component[v] + 1]++;
+    for (int c = 0; c < count; c++) member_offsets[c + 1] += member_offsets[c];
+    members.assign(n, 0);
+    {
+        std::vector<int> next(member_offsets.begin(), member_offsets.end() - 1);
+        for (int v = 0; v < n; v++) members[next[scc.component[v]]++] = v;
+    }
+
+    //* edges between components, counting-sorted by target and then stably by source,
+    //* which leaves every row sorted; duplicates end up next to each other
+    std::vector<int> by_target_offsets(count + 1, 0);
+    for (int v = 0; v < n; v++) {
+        const int from = scc.component[v];
+        graph.for_each_out_neighbor(v, [&](int v_incoming, int) {
+            if (scc.component[v_incoming] != from) by_target_offsets[scc.component[v_incoming] + 1]++;
+        });
+    }
+    for (int c = 0; c < count; c++) by_target_offsets[c + 1] += by_target_offsets[c];
+    const int crossing = by_target_offsets[count];
+    std::vector<int> sources_by_target(crossing);
+    {
+        std::vector<int> next(by_target_offsets.begin(), by_target_offsets.end() - 1);
+        for (int v = 0; v < n; v++) {
+            const int from = scc.component[v];
+            graph.for_each_out_neighbor(v, [&](int v_incoming, int) {
+                const int to = scc.component[v_incoming];
+                if (to != from) sources_by_target[next[to]++] = from;
+            });
+        }
+    }
+
+    std::vector<int> raw_offsets(count + 1, 0);
+    for (int from : sources_by_target) raw_offsets[from + 1]++;
+    for (int c = 0; c < count; c++) raw_offsets[c + 1] += raw_offsets[c];
+    std::vector<int> raw(crossing);
+    {
+        std::vector<int> next(raw_offsets.begin(), raw_offsets.end() - 1);
+        for (int to = 0; to < count; to++) {
+            for (int i = by_target_offsets[to]; i < by_target_offsets[to + 1]; i++) raw[next[sources_by_target[i]]++] = to;
+        }
+    }
+    sources_by_target = std::vector<int>();
+
+    offsets.assign(count + 1, 0);
+    successors.clear();
+    multiplicity.clear();
+    for (int c = 0; c < count; c++) {
+        for (int i = raw_offsets[c]; i < raw_offsets[c + 1]; i++) {
+            if (i > raw_offsets[c] && raw[i] == raw[i - 1]) {
+                multiplicity.back()++;
+                continue;
+            }
+            successors.push_back(raw[i]);
+            multiplicity.push_back(1);
+        }
+        offsets[c + 1] = static_cast<int>(successors.size());
+    }
+
+    //* in-edges: rows are visited by increasing source, so every in-row is sorted too
+    in_offsets.assign(count + 1, 0);
+    for (int to : successors) in_offsets[to + 1]++;
+    for (int c = 0; c < count; c++) in_offsets[c + 1] += in_offsets[c];
+    predecessors.assign(successors.size(), 0);
+    in_multiplicity.assign(successors.size(), 0);
+    {
+        std::vector<int> next(in_offsets.begin(), in_offsets.end() - 1);
+        for (int c = 0; c < count; c++) {
+            for (int i = offsets[c]; i < offsets[c + 1]; i++) {
+                const int slot = next[successors[i]]++;
+                predecessors[slot] = c;
+                in_multiplicity[slot] = multiplicity[i];
+            }
+        }
+    }
+
+    sort_levels(threads);
+}
+
+/**
+ * @brief Kahn's algorithm, one level at a time: the order array doubles as the queue, and
+ * a level's successors whose in-degree drops to 0 are appended as the next level.
+ */
+void Condensation::sort_levels(int threads) {
+    const int count = scc.count;
+    std::vector<int> remaining(count);
+    order.assign(count, 0);
+    level.assign(count, 0);
+    level_offsets.assign(1, 0);
+
+    int tail = 0;
+    for (int c = count - 1; c >= 0; c--) {
+        remaining[c] = in_degree(c);
+        if (remaining[c] == 0) order[tail++] = c;
+    }
+
+    int head = 0;
+    while (head < tail) {
+        const int begin = head, end = tail;
+        const int depth = static_cast<int>(level_offsets.size()) - 1;
+        level_offsets.push_back(end);
+
+        if (end - begin < SERIAL_LEVEL || threads <= 1) {
+            for (int i = begin; i < end; i++) {
+                const int c = order[i];
+                level[c] = depth;
+                for (int e = offsets[c]; e < offsets[c + 1]; e++) {
+                    if (--remaining[successors[e]] == 0) order[tail++] = successors[e];
+                }
+            }
+        } else {
+            std::atomic<int> shared_tail(tail);
+            const int chunks = (end - begin + LEVEL_CHUNK - 1) / LEVEL_CHUNK;
+            parallel_for(0, chunks, [&](int chunk) {
+                const int last = std::min(end, begin + (chunk + 1) * LEVEL_CHUNK);
+                for (int i = begin + chunk * LEVEL_CHUNK; i < last; i++) {
+                    const int c = order[i];
+                    level[c] = depth;
+                    for (int e = offsets[c]; e < offsets[c + 1]; e++) {
+                        const int s = successors[e];
+                        if (std::atomic_ref<int>(remaining[s]).fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                            order[shared_tail.fetch_add(1, std::memory_order_relaxed)] = s;
+                        }
+                    }
+                }
+            }, threads);
+            tail = shared_tail.load();
+        }
+        head = end;
+    }
+}
+
+void Condensation::release(SccResult& components, std::vector<int>& out_offsets, std::vector<int>& out_successors) {
+    components = std::move(scc);
+    out_offsets = std::move(offsets);
+    out_successors = std::move(successors);
+    *this = Condensation();
+}
+
+size_t Condensation::memory_usage() const {
+    return (scc.component.capacity() + offsets.capacity() + successors.capacity() + multiplicity.capacity() +
+            in_offsets.capacity() + predecessors.capacity() + in_multiplicity.capacity() + member_offsets.capacity() +
+            members.capacity() + order.capacity() + level_offsets.capacity() + level.capacity()) * sizeof(int);
+}
+
+//! kondensacja grafu z porządkiem topologicznym, patrz Condensation
+template<OutNeighborGraph G>
+Condensation condense(const G& graph, int threads = 1) {
+    Condensation condensation;
+    condensation.build(graph, threads);
+    return condensation;
+}
+
+Condensation condense(const Graph& graph, int threads = 1) {
+    return condense(VirtualGraph(graph), threads);
+}
+
+//! wierzchołki grafu w porządku topologicznym kondensacji (wierzchołki komponentu obok siebie)
+std::vector<int> topological_order(const Condensation& condensation) {
+    std::vector<int> result;
+    result.reserve(condensation.get_components().component.size());
+    for (int c : condensation.get_order()) {
+        condensation.for_each_member(c, [&result](int v) { result.push_back(v);});
+    }
+    return result;
+}
+#endif
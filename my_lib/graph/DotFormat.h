@@ -0,0 +1,534 @@
+#ifndef DOT_FORMAT_H
+#define DOT_FORMAT_H
+
+#include "Graph.h"
+#include "BufferedWriter.h"
+#include "StronglyConnected.h"
+#include "VertexIdMap.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Single-pass reader of Graphviz DOT files (the format of graph.dot).
+ * @note The file is read in fixed-size chunks and every edge is handed to the handler
+ * @note as soon as its statement ends, so the memory used does not depend on the file size.
+ * @note Supported: strict/graph/digraph header, "a -> b -> c" chains, "--" edges,
+ * @note attribute lists (weight= or numeric label= becomes the edge weight), ports,
+ * @note subgraph blocks, quoted and HTML ids, line, block and # comments.
+ * @note Node statements without edges are skipped; only the first graph in a file is read.
+ */
+class DotReader {
+    public:
+        //* return false to stop reading
+        using EdgeHandler = std::function<bool(const std::string& from, const std::string& to, int weight)>;
+
+        DotReader(size_t buffer_size = 1 << 16) : buffer(buffer_size < 16 ? 16 : buffer_size) {}
+
+        bool read(const std::string& filename, const EdgeHandler& handler);
+        bool read(std::FILE *input, const EdgeHandler& handler);
+
+        bool is_directed() const { return directed;} //* valid once the header has been read
+        size_t edges_read() const { return number_of_edges;}
+        const std::string& error() const { return error_message;}
+
+    private:
+        enum class Token { END, ID, LBRACE, RBRACE, LBRACKET, RBRACKET, SEMICOLON, COMMA, EQUALS, COLON, EDGE_OP, INVALID };
+
+        std::FILE *stream = nullptr;
+        std::vector<char> buffer;
+        size_t position = 0;
+        size_t filled = 0;
+        int line = 1;
+        bool directed = true;
+        size_t number_of_edges = 0;
+        std::string error_message;
+
+        std::string text;           // treść ostatniego tokenu ID
+        Token peeked = Token::END;
+        bool has_peeked = false;
+        std::vector<std::string> chain;
+        std::string key;
+
+        int peek_char() {
+            if (position == filled) {
+                filled = stream ? std::fread(buffer.data(), 1, buffer.size(), stream) : 0;
+                position = 0;
+                if (filled == 0) return EOF;
+            }
+            return static_cast<unsigned char>(buffer[position]);
+        }
+
+        int get_char() {
+            const int c = peek_char();
+            if (c != EOF) {
+                position++;
+                if (c == '\n') line++;
+            }
+            return c;
+        }
+
+        static bool is_id_char(int c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                    c == '_' || c == '.' || c >= 0x80;
+        }
+
+        static bool is_keyword(const std::string& word, const char *keyword);
+
+        Token next_token();
+        Token lex_token();
+        Token peek_token() {
+            if (!has_peeked) {
+                peeked = lex_token();
+                has_peeked = true;
+            }
+            return peeked;
+        }
+
+        bool fail(const std::string& message) {
+            if (error_message.empty()) error_message = "line " + std::to_string(line) + ": " + message;
+            return false;
+        }
+
+        bool parse_attributes(int& weight);
+        bool parse_node_id(std::string& id);
+};
+
+bool DotReader::read(const std::string& filename, const EdgeHandler& handler) {
+    std::FILE *input = std::fopen(filename.c_str(), "rb");
+    if (!input) {
+        error_message = "can not open " + filename;
+        return false;
+    }
+
+    const bool result = read(input, handler);
+    std::fclose(input);
+    return result;
+}
+
+bool DotReader::is_keyword(const std::string& word, const char *keyword) {
+    // słowa kluczowe w DOT nie zależą od wielkości liter
+    size_t i = 0;
+    for (; keyword[i]; i++) {
+        if (i == word.size()) return false;
+        char c = word[i];
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        if (c != keyword[i]) return false;
+    }
+    return i == word.size();
+}
+
+DotReader::Token DotReader::next_token() {
+    if (has_peeked) {
+        has_peeked = false;
+        return peeked;
+    }
+    return lex_token();
+}
+
+DotReader::Token DotReader::lex_token() {
+    int c;
+    for (;;) {
+        c = get_char();
+        if (c == EOF) return Token::END;
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') continue;
+
+        if (c == '#') {
+            while ((c = get_char()) != EOF && c != '\n') {}
+            continue;
+        }
+
+        if (c == '/' && peek_char() == '/') {
+            while ((c = get_char()) != EOF && c != '\n') {}
+            continue;
+        }
+
+        if (c == '/' && peek_char() == '*') {
+            get_char();
+            int previous = 0;
+            while ((c = get_char()) != EOF && !(previous == '*' && c == '/')) previous = c;
+            if (c == EOF) {
+                fail("unterminated comment");
+                return Token::INVALID;
+            }
+            continue;
+        }
+        break;
+    }
+
+    switch (c) {
+        case '{': return Token::LBRACE;
+        case '}': return Token::RBRACE;
+        case '[': return Token::LBRACKET;
+        case ']': return Token::RBRACKET;
+        case ';': return Token::SEMICOLON;
+        case ',': return Token::COMMA;
+        case '=': return Token::EQUALS;
+        case ':': return Token::COLON;
+        default: break;
+    }
+
+    text.clear();
+
+    if (c == '-' && (peek_char() == '>' || peek_char() == '-')) {
+        get_char();
+        return Token::EDGE_OP;
+    }
+
+    if (c == '"') {
+        while ((c = get_char()) != EOF && c != '"') {
+            if (c == '\\') {
+                const int escaped = get_char();
+                if (escaped == '\n' || escaped == EOF) continue; // kontynuacja linii
+                if (escaped != '"') text.push_back('\\');
+                c = escaped;
+            }
+            text.push_back(static_cast<char>(c));
+        }
+        if (c == EOF) {
+            fail("unterminated string");
+            return Token::INVALID;
+        }
+        return Token::ID;
+    }
+
+    if (c == '<') {
+        int depth = 1;
+        while ((c = get_char()) != EOF) {
+            if (c == '<') depth++;
+            else if (c == '>' && --depth == 0) break;
+            text.push_back(static_cast<char>(c));
+        }
+        if (c == EOF) {
+            fail("unterminated HTML string");
+            return Token::INVALID;
+        }
+        return Token::ID;
+    }
+
+    if (c == '-' || is_id_char(c)) {
+        text.push_back(static_cast<char>(c));
+        while (is_id_char(peek_char())) text.push_back(static_cast<char>(get_char()));
+        return Token::ID;
+    }
+
+    fail(std::string("unexpected character '") + static_cast<char>(c) + "'");
+    return Token::INVALID;
+}
+
+bool DotReader::parse_attributes(int& weight) {
+    bool has_weight = false;
+    for (;;) {
+        Token token = next_token();
+        if (token == Token::RBRACKET) break;
+        if (token == Token::COMMA || token == Token::SEMICOLON) continue;
+        if (token != Token::ID) return fail("expected attribute name");
+
+        key = text;
+        if (next_token() != Token::EQUALS) return fail("expected '=' after attribute " + key);
+        if (next_token() != Token::ID) return fail("expected value of attribute " + key);
+
+        const bool is_weight = key == "weight";
+        if (is_weight || (key == "label" && !has_weight)) {
+            char *end = nullptr;
+            errno = 0;
+            const long value = std::strtol(text.c_str(), &end, 10);
+            if (end != text.c_str() && *end == '\0') {
+                //* a numeric weight that does not fit is an error, as in read_edge_list, not a truncated int
+                if (errno == ERANGE || value < INT_MIN || value > INT_MAX) return fail("weight out of range");
+                weight = static_cast<int>(value);
+                has_weight = has_weight || is_weight;
+            }
+        }
+    }
+
+    //* "a -> b [..] [..]" is valid DOT as well
+    if (peek_token() == Token::LBRACKET) {
+        next_token();
+        return parse_attributes(weight);
+    }
+    return true;
+}
+
+bool DotReader::parse_node_id(std::string& id) {
+    id = text;
+    //* porty ("a:n" albo "a:port:sw") nie mają znaczenia dla struktury grafu
+    while (peek_token() == Token::COLON) {
+        next_token();
+        if (next_token() != Token::ID) return fail("expected port name");
+    }
+    return true;
+}
+
+bool DotReader::read(std::FILE *input, const EdgeHandler& handler) {
+    stream = input;
+    position = filled = 0;
+    line = 1;
+    directed = true;
+    number_of_edges = 0;
+    has_peeked = false;
+    error_message.clear();
+
+    Token token = next_token();
+    if (token == Token::ID && is_keyword(text, "strict")) token = next_token();
+    if (token != Token::ID || !(is_keyword(text, "digraph") || is_keyword(text, "graph"))) {
+        return fail("expected 'digraph' or 'graph'");
+    }
+    directed = is_keyword(text, "digraph");
+
+    token = next_token();
+    if (token == Token::ID) token = next_token();
+    if (token != Token::LBRACE) return fail("expected '{'");
+
+    int depth = 1;
+    while (depth > 0) {
+        token = next_token();
+        switch (token) {
+            case Token::RBRACE:
+                depth--;
+                continue;
+            case Token::LBRACE:
+                depth++;
+                continue;
+            case Token::SEMICOLON:
+            case Token::COMMA:
+                continue;
+            case Token::END:
+                return fail("unexpected end of file");
+            case Token::ID:
+                break;
+            default:
+                return fail("unexpected token");
+        }
+
+        //* reuse the strings of the previous chain, so there is no allocation per edge
+        size_t length = 1;
+        if (chain.empty()) chain.emplace_back();
+        if (!parse_node_id(chain[0])) return false;
+
+        if (is_keyword(chain[0], "subgraph")) {
+            if (peek_token() == Token::ID) next_token();
+            if (next_token() != Token::LBRACE) return fail("expected '{' after subgraph");
+            depth++;
+            continue;
+        }
+
+        if ((is_keyword(chain[0], "graph") || is_keyword(chain[0], "node") || is_keyword(chain[0], "edge")) &&
+                peek_token() == Token::LBRACKET) {
+            next_token();
+            int ignored = 0;
+            if (!parse_attributes(ignored)) return false;
+            continue;
+        }
+
+        if (peek_token() == Token::EQUALS) {
+            next_token();
+            if (next_token() != Token::ID) return fail("expected value of " + chain[0]);
+            continue;
+        }
+
+        while (peek_token() == Token::EDGE_OP) {
+            next_token();
+            token = next_token();
+            if (token == Token::LBRACE || (token == Token::ID && is_keyword(text, "subgraph"))) {
+                return fail("subgraph as an edge operand is not supported");
+            }
+            if (token != Token::ID) return fail("expected node after edge operator");
+            if (chain.size() == length) chain.emplace_back();
+            if (!parse_node_id(chain[length++])) return false;
+        }
+
+        int weight = 0;
+        if (peek_token() == Token::LBRACKET) {
+            next_token();
+            if (!parse_attributes(weight)) return false;
+        }
+
+        for (size_t i = 1; i < length; i++) {
+            number_of_edges++;
+            if (!handler(chain[i - 1], chain[i], weight)) return fail("stopped by the edge handler");
+        }
+    }
+
+    stream = nullptr;
+    return true;
+}
+
+struct DotWriterOptions {
+    std::string name;               //* name written after "digraph", empty for anonymous graph
+    bool weights = false;           //* write edge weights as label attributes
+    std::vector<int> components;    //* colour label per vertex (SCC, cycle...), -1 means no colour
+    const VertexIdMap *ids = nullptr; //* write original ids instead of dense ones (EdgeList::ids)
+    int indent = 0;                 //* number of spaces in front of every line
+};
+
+/**
+ * @brief Streams any Graph backend as a DOT digraph through a BufferedWriter.
+ * @note With components set, vertices of one component share a fill colour and edges
+ * @note inside a component are drawn in that colour, so cycles stand out in Graphviz.
+ */
+class DotWriter {
+    public:
+        DotWriter(const DotWriterOptions& options = DotWriterOptions()) : options(options) {}
+
+        void write(const Graph& graph, BufferedWriter& out) const;
+
+        //* the parts of write(), for writers that choose the edges themselves (GraphDump)
+        void write_header(BufferedWriter& out, int number_of_vertices) const;
+        void write_edge(BufferedWriter& out, int v_outgoing, int v_incoming, int weight) const;
+        void write_footer(BufferedWriter& out) const;
+
+    private:
+        DotWriterOptions options;
+
+        void write_vertex(BufferedWriter& out, int v) const {
+            if (options.ids) out.write_uint(options.ids->original(v));
+            else out.write_int(v);
+        }
+
+        int label_of(int vertex) const {
+            return (vertex < static_cast<int>(options.components.size())) ? options.components[vertex] : -1;
+        }
+
+        static const char *colour(int label) {
+            //* ColorBrewer "set3" palette
+            static const char *palette[] = {
+                "#8dd3c7", "#ffffb3", "#bebada", "#fb8072", "#80b1d3", "#fdb462",
+                "#b3de69", "#fccde5", "#d9d9d9", "#bc80bd", "#ccebc5", "#ffed6f"
+            };
+            return palette[label % (sizeof(palette) / sizeof(palette[0]))];
+        }
+};
+
+void DotWriter::write(const Graph& graph, BufferedWriter& out) const {
+    const int n = graph.get_number_of_vertices();
+
+    write_header(out, n);
+    for (int v = 0; v < n; v++) {
+        graph.for_each_emanating(v, [&](int v_incoming, int weight) {
+            write_edge(out, v, v_incoming, weight);
+        });
+    }
+    write_footer(out);
+}
+
+void DotWriter::write_header(BufferedWriter& out, int number_of_vertices) const {
+    out.pad(options.indent);
+    out.write("digraph ");
+    if (!options.name.empty()) {
+        out.put('"');
+        out.write(options.name);
+        out.write("\" ");
+    }
+    out.write("{\n");
+
+    if (!options.components.empty()) {
+        out.pad(options.indent);
+        out.write("    node [style=filled, fillcolor=white]\n");
+        for (int v = 0; v < number_of_vertices; v++) {
+            const int label = label_of(v);
+            if (label < 0) continue;
+            out.pad(options.indent);
+            out.write("    ");
+            write_vertex(out, v);
+            out.write(" [fillcolor=\"");
+            out.write(colour(label));
+            out.write("\", component=");
+            out.write_int(label);
+            out.write("]\n");
+        }
+    }
+}
+
+void DotWriter::write_edge(BufferedWriter& out, int v_outgoing, int v_incoming, int weight) const {
+    const int label = label_of(v_outgoing);
+
+    out.pad(options.indent);
+    out.write("    ");
+    write_vertex(out, v_outgoing);
+    out.write(" -> ");
+    write_vertex(out, v_incoming);
+
+    const bool coloured = label >= 0 && label == label_of(v_incoming);
+    if (options.weights || coloured) {
+        out.write(" [");
+        if (options.weights) {
+            out.write("label=");
+            out.write_int(weight);
+            if (coloured) out.write(", ");
+        }
+        if (coloured) {
+            out.write("color=\"");
+            out.write(colour(label));
+            out.write("\", penwidth=2");
+        }
+        out.put(']');
+    }
+    out.put('\n');
+}
+
+void DotWriter::write_footer(BufferedWriter& out) const {
+    out.pad(options.indent);
+    out.write("}\n");
+}
+
+/**
+ * @brief Adds every edge of a DOT file with numeric vertex names to the graph.
+ * @note Edges of an undirected "graph" are added in both directions.
+ */
+bool read_dot(const std::string& filename, Graph& graph, std::string *error = nullptr) {
+    DotReader reader;
+    bool bad_name = false;
+    std::string bad_id;
+
+    auto to_index = [](const std::string& id, int& index) {
+        if (id.empty() || id.size() > 9) return false;
+        index = 0;
+        for (char c : id) {
+            if (c < '0' || c > '9') return false;
+            index = index * 10 + (c - '0');
+        }
+        return true;
+    };
+
+    const bool result = reader.read(filename, [&](const std::string& from, const std::string& to, int weight) {
+        int v_outgoing, v_incoming;
+        //* a bool, not bad_id.empty(): an empty name ("") is a bad name as well
+        if (!to_index(from, v_outgoing) || !to_index(to, v_incoming)) {
+            bad_name = true;
+            bad_id = to_index(from, v_outgoing) ? to : from;
+            return false;
+        }
+
+        graph.add_edge(v_outgoing, v_incoming, weight);
+        if (!reader.is_directed() && v_outgoing != v_incoming) graph.add_edge(v_incoming, v_outgoing, weight);
+        return true;
+    });
+
+    if (!result && error) {
+        if (!bad_name) *error = reader.error();
+        else if (bad_id.empty()) *error = "empty vertex name";
+        else *error = "vertex name \"" + bad_id + "\" is not a number";
+    }
+    return result;
+}
+
+/**
+ * @brief Writes the graph to a DOT file, optionally coloured by strongly connected components.
+ */
+bool write_dot(const std::string& filename, const Graph& graph, bool colour_components = false) {
+    BufferedWriter file(filename, false);
+    if (!file.is_open()) return false;
+
+    DotWriterOptions options;
+    if (colour_components) {
+        options.components = cyclic_component_labels(graph, strongly_connected_components(graph));
+    }
+    DotWriter(options).write(graph, file);
+    return true;
+}
+#endif
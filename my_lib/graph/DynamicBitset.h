@@ -0,0 +1,80 @@
+#ifndef DYNAMIC_BITSET_H
+#define DYNAMIC_BITSET_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Bitmap with one bit per vertex stored in 64-bit words.
+ * @note Replaces std::set<int> where only membership and the number of members are needed:
+ * @note set() is one OR instead of a red-black tree insert and count() is one popcount per word.
+ */
+class DynamicBitset {
+    public:
+        DynamicBitset() {}
+        DynamicBitset(size_t size) : words((size + 63) / 64, 0), number_of_bits(size) {}
+
+        size_t size() const { return number_of_bits;}
+        bool empty() const { return number_of_bits == 0;}
+
+        void resize(size_t size) {
+            words.resize((size + 63) / 64, 0);
+            //* bits behind the new end must be zero, count() relies on it
+            if (size % 64 && size < number_of_bits) words.back() &= (uint64_t(1) << (size % 64)) - 1;
+            number_of_bits = size;
+        }
+
+        void reset() { std::fill(words.begin(), words.end(), 0);}
+        void clear() {
+            words.clear();
+            number_of_bits = 0;
+        }
+
+        bool test(size_t idx) const { return (words[idx >> 6] >> (idx & 63)) & 1;}
+
+        //! ustawia bit i zwraca true, jeśli wcześniej nie był ustawiony
+        bool set(size_t idx) {
+            uint64_t& word = words[idx >> 6];
+            const uint64_t bit = uint64_t(1) << (idx & 63);
+            const bool was_set = (word & bit) != 0;
+            word |= bit;
+            return !was_set;
+        }
+
+        void unset(size_t idx) { words[idx >> 6] &= ~(uint64_t(1) << (idx & 63));}
+
+        size_t count() const {
+            size_t result = 0;
+            for (uint64_t word : words) result += popcount(word);
+            return result;
+        }
+
+        uint64_t *data() { return words.data();}
+        const uint64_t *data() const { return words.data();}
+        size_t number_of_words() const { return words.size();}
+
+        static int popcount(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_popcountll(word);
+#else
+            int result = 0;
+            for (; word; word &= word - 1) result++;
+            return result;
+#endif
+        }
+
+        //! numer najmłodszego ustawionego bitu, word nie może być 0
+        static int lowest_bit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctzll(word);
+#else
+            return popcount((word & (~word + 1)) - 1);
+#endif
+        }
+
+    private:
+        std::vector<uint64_t> words;
+        size_t number_of_bits = 0;
+};
+#endif
@@ -0,0 +1,259 @@
+#ifndef EDGE_INDEX_H
+#define EDGE_INDEX_H
+
+#include "../../include/SDL2/SDL_cpuinfo.h"
+#include "EdgeList.h"
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define EDGE_INDEX_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define EDGE_INDEX_TARGET(isa) __attribute__((target(isa)))
+#else
+#define EDGE_INDEX_TARGET(isa)
+#endif
+
+/**
+ * @brief Hash index of edges: packed (v_outgoing, v_incoming) 64-bit key -> int value (e.g. edge id).
+ * @note Open addressing over buckets of 8 keys, one 64-byte cache line each; a key is looked up
+ * @note in its home bucket (Fibonacci hashing) with one SIMD compare of all 8 slots against the
+ * @note key and against EMPTY, and only a full bucket sends the probe to the next one.
+ * @note Values live in a separate array, so a miss costs one cache line and a hit two.
+ * @note The table is kept at most 3/4 full; there is no erase, as graphs never lose edges.
+ */
+class EdgeIndex {
+    public:
+        enum class Kernel { SCALAR, SSE41, AVX2 };
+
+        static constexpr int BUCKET = 8;     //* keys per bucket (one cache line)
+        static constexpr int ABSENT = -1;    //* find() result for a missing edge
+
+        EdgeIndex(Kernel kernel = detect_kernel()) : kernel(kernel) {}
+        //* keys points into storage, moving the vector keeps it valid, copying would not
+        EdgeIndex(const EdgeIndex&) = delete;
+        EdgeIndex& operator=(const EdgeIndex&) = delete;
+        EdgeIndex(EdgeIndex&&) = default;
+        EdgeIndex& operator=(EdgeIndex&&) = default;
+
+        static Kernel detect_kernel();
+        Kernel get_kernel() const { return kernel;}
+
+        size_t size() const { return number_of_keys;}
+        size_t memory_usage() const { return storage.capacity() * sizeof(uint64_t) + values.capacity() * sizeof(int);}
+
+        void reserve(size_t expected);
+        void clear();
+
+        //! dodaje krawędź, zwraca false (i nie zmienia wartości), jeśli już była w indeksie
+        bool insert(int v_outgoing, int v_incoming, int value);
+        //! zmienia wartość krawędzi, która jest w indeksie
+        void assign(int v_outgoing, int v_incoming, int value);
+
+        int find(int v_outgoing, int v_incoming) const {
+            const size_t slot = find_slot(key(v_outgoing, v_incoming));
+            return (slot != NOT_FOUND) ? values[slot] : ABSENT;
+        }
+        bool contains(int v_outgoing, int v_incoming) const { return find_slot(key(v_outgoing, v_incoming)) != NOT_FOUND;}
+
+        /**
+         * @brief find() for many edges at once: home buckets are prefetched a few queries ahead,
+         * so the cache misses of consecutive probes overlap.
+         */
+        void find_batch(const EdgeRecord *queries, size_t count, int *results) const;
+
+    private:
+        static constexpr uint64_t EMPTY = ~uint64_t(0); // wierzchołki mają nieujemne numery
+        static constexpr size_t NOT_FOUND = ~size_t(0);
+        static constexpr size_t PREFETCH_DISTANCE = 8;
+
+        Kernel kernel;
+        std::vector<uint64_t> storage;  // klucze z zapasem na wyrównanie do 64 bajtów
+        uint64_t *keys = nullptr;
+        std::vector<int> values;
+        size_t number_of_keys = 0;
+        size_t bucket_mask = 0;
+        int shift = 64;
+
+        static uint64_t key(int v_outgoing, int v_incoming) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(v_outgoing)) << 32) | static_cast<uint32_t>(v_incoming);
+        }
+
+        size_t home(uint64_t id) const {
+            return static_cast<size_t>((id * 0x9E3779B97F4A7C15ULL) >> shift) & bucket_mask;
+        }
+
+        //* bit i of the result is set when slot i of the bucket holds id, bit 8 + i when it is EMPTY
+        unsigned match(const uint64_t *bucket, uint64_t id) const;
+        static unsigned match_scalar(const uint64_t *bucket, uint64_t id);
+#ifdef EDGE_INDEX_X86
+        static unsigned match_sse41(const uint64_t *bucket, uint64_t id);
+        static unsigned match_avx2(const uint64_t *bucket, uint64_t id);
+#endif
+
+        size_t find_slot(uint64_t id) const;
+        size_t insert_slot(uint64_t id, bool& inserted);
+        void rehash(size_t buckets);
+
+        static int count_trailing_zeros(unsigned mask) {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctz(mask);
+#else
+            int count = 0;
+            while (!(mask & 1)) {
+                mask >>= 1;
+                count++;
+            }
+            return count;
+#endif
+        }
+};
+
+EdgeIndex::Kernel EdgeIndex::detect_kernel() {
+#ifdef EDGE_INDEX_X86
+    if (SDL_HasAVX2()) return Kernel::AVX2;
+    if (SDL_HasSSE41()) return Kernel::SSE41;
+#endif
+    return Kernel::SCALAR;
+}
+
+void EdgeIndex::reserve(size_t expected) {
+    size_t buckets = 1;
+    while (buckets * BUCKET * 3 < expected * 4) buckets *= 2;
+    if (buckets * BUCKET > values.size()) rehash(buckets);
+}
+
+void EdgeIndex::clear() {
+    storage.clear();
+    values.clear();
+    keys = nullptr;
+    number_of_keys = 0;
+    bucket_mask = 0;
+    shift = 64;
+}
+
+unsigned EdgeIndex::match_scalar(const uint64_t *bucket, uint64_t id) {
+    unsigned result = 0;
+    for (int i = 0; i < BUCKET; i++) {
+        if (bucket[i] == id) result |= 1u << i;
+        if (bucket[i] == EMPTY) result |= 1u << (BUCKET + i);
+    }
+    return result;
+}
+
+#ifdef EDGE_INDEX_X86
+EDGE_INDEX_TARGET("sse4.1")
+unsigned EdgeIndex::match_sse41(const uint64_t *bucket, uint64_t id) {
+    const __m128i wanted = _mm_set1_epi64x(static_cast<long long>(id));
+    const __m128i empty = _mm_set1_epi64x(-1);
+    unsigned found = 0, free = 0;
+    for (int i = 0; i < BUCKET; i += 2) {
+        const __m128i slots = _mm_load_si128(reinterpret_cast<const __m128i*>(bucket + i));
+        found |= static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(slots, wanted)))) << i;
+        free |= static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(slots, empty)))) << i;
+    }
+    return found | (free << BUCKET);
+}
+
+EDGE_INDEX_TARGET("avx2")
+unsigned EdgeIndex::match_avx2(const uint64_t *bucket, uint64_t id) {
+    const __m256i wanted = _mm256_set1_epi64x(static_cast<long long>(id));
+    const __m256i empty = _mm256_set1_epi64x(-1);
+    const __m256i low = _mm256_load_si256(reinterpret_cast<const __m256i*>(bucket));
+    const __m256i high = _mm256_load_si256(reinterpret_cast<const __m256i*>(bucket + 4));
+
+    const unsigned found = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(low, wanted)))) |
+            static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(high, wanted)))) << 4;
+    const unsigned free = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(low, empty)))) |
+            static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(high, empty)))) << 4;
+    return found | (free << BUCKET);
+}
+#endif
+
+unsigned EdgeIndex::match(const uint64_t *bucket, uint64_t id) const {
+#ifdef EDGE_INDEX_X86
+    if (kernel == Kernel::AVX2) return match_avx2(bucket, id);
+    if (kernel == Kernel::SSE41) return match_sse41(bucket, id);
+#endif
+    return match_scalar(bucket, id);
+}
+
+size_t EdgeIndex::find_slot(uint64_t id) const {
+    if (number_of_keys == 0) return NOT_FOUND;
+
+    for (size_t b = home(id);; b = (b + 1) & bucket_mask) {
+        const unsigned mask = match(keys + b * BUCKET, id);
+        if (mask & ((1u << BUCKET) - 1)) return b * BUCKET + count_trailing_zeros(mask);
+        if (mask >> BUCKET) return NOT_FOUND; // w kubełku jest wolne miejsce, więc klucza nie ma dalej
+    }
+}
+
+//* slots of a bucket are filled from the left, so the first EMPTY slot is the place for a new key
+size_t EdgeIndex::insert_slot(uint64_t id, bool& inserted) {
+    if (4 * (number_of_keys + 1) > 3 * values.size()) rehash(values.empty() ? 1 : 2 * (bucket_mask + 1));
+
+    for (size_t b = home(id);; b = (b + 1) & bucket_mask) {
+        const unsigned mask = match(keys + b * BUCKET, id);
+        if (mask & ((1u << BUCKET) - 1)) {
+            inserted = false;
+            return b * BUCKET + count_trailing_zeros(mask);
+        }
+        if (mask >> BUCKET) {
+            const size_t slot = b * BUCKET + count_trailing_zeros(mask >> BUCKET);
+            keys[slot] = id;
+            number_of_keys++;
+            inserted = true;
+            return slot;
+        }
+    }
+}
+
+bool EdgeIndex::insert(int v_outgoing, int v_incoming, int value) {
+    bool inserted;
+    const size_t slot = insert_slot(key(v_outgoing, v_incoming), inserted);
+    if (inserted) values[slot] = value;
+    return inserted;
+}
+
+void EdgeIndex::assign(int v_outgoing, int v_incoming, int value) {
+    const size_t slot = find_slot(key(v_outgoing, v_incoming));
+    if (slot != NOT_FOUND) values[slot] = value;
+}
+
+void EdgeIndex::find_batch(const EdgeRecord *queries, size_t count, int *results) const {
+    for (size_t i = 0; i < count; i++) {
+#if defined(__GNUC__) || defined(__clang__)
+        if (number_of_keys && i + PREFETCH_DISTANCE < count) {
+            const EdgeRecord& next = queries[i + PREFETCH_DISTANCE];
+            __builtin_prefetch(keys + home(key(next.v_outgoing, next.v_incoming)) * BUCKET);
+        }
+#endif
+        results[i] = find(queries[i].v_outgoing, queries[i].v_incoming);
+    }
+}
+
+void EdgeIndex::rehash(size_t buckets) {
+    std::vector<uint64_t> old_storage(buckets * BUCKET + BUCKET, EMPTY);
+    old_storage.swap(storage);
+    const uint64_t *old_keys = keys;
+    std::vector<int> old_values(buckets * BUCKET, ABSENT);
+    old_values.swap(values);
+
+    //* the vector gives 8-byte alignment, the buckets start at the first 64-byte boundary inside
+    const uintptr_t address = reinterpret_cast<uintptr_t>(storage.data());
+    keys = storage.data() + ((64 - address % 64) % 64) / sizeof(uint64_t);
+    bucket_mask = buckets - 1;
+    shift = 64;
+    for (size_t c = buckets; c > 1; c >>= 1) shift--;
+
+    number_of_keys = 0;
+    for (size_t slot = 0; slot < old_values.size(); slot++) {
+        if (old_keys[slot] == EMPTY) continue;
+        bool inserted;
+        values[insert_slot(old_keys[slot], inserted)] = old_values[slot];
+    }
+}
+#endif
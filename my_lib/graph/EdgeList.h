@@ -0,0 +1,85 @@
+#ifndef EDGE_LIST_H
+#define EDGE_LIST_H
+
+#include "EdgeListTokenizer.h"
+#include "VertexIdMap.h"
+#include <climits>
+#include <string>
+#include <vector>
+
+struct EdgeRecord {
+    int v_outgoing;
+    int v_incoming;
+    int weight;
+};
+
+/**
+ * @brief Edges read from a file before any Graph backend is built.
+ * @note With compaction the vertex ids of the file may be any numbers from 0 to 2^64-1: they are
+ * @note renumbered to 0..k-1 in order of first appearance and ids keeps the way back.
+ */
+struct EdgeList {
+    int number_of_vertices = 0;
+    std::vector<EdgeRecord> edges;
+    VertexIdMap ids;        //* dense id <-> id from the file, empty without compaction
+    bool compacted = false;
+
+    //! zwraca identyfikator wierzchołka z pliku (przed kompaktowaniem)
+    uint64_t original(int v) const { return compacted ? ids.original(v) : static_cast<uint64_t>(v);}
+};
+
+/**
+ * @brief Reads "v_outgoing v_incoming [weight]" lines with EdgeListTokenizer.
+ * @param compact map ids through VertexIdMap; without it ids must be in 0..INT_MAX-1
+ * and number_of_vertices is the largest id + 1
+ */
+bool read_edge_list(const std::string& filename, EdgeList& list, bool compact = true, std::string *error = nullptr) {
+    list.number_of_vertices = 0;
+    list.edges.clear();
+    list.ids.clear();
+    list.compacted = compact;
+
+    std::string message;
+    EdgeListTokenizer tokenizer;
+    const bool result = tokenizer.read(filename, [&](const long long *fields, int count) {
+        if (count < 2) {
+            message = "line " + std::to_string(tokenizer.get_lines() + 1) + ": expected two vertices";
+            return false;
+        }
+
+        if (count > 2 && (fields[2] < INT_MIN || fields[2] > INT_MAX)) {
+            message = "line " + std::to_string(tokenizer.get_lines() + 1) + ": weight out of range";
+            return false;
+        }
+
+        //* ids are read without sign, so ids of 2^63 and more are not clamped to INT64_MAX
+        unsigned long long v_outgoing, v_incoming;
+        if (!tokenizer.get_unsigned(0, v_outgoing) || !tokenizer.get_unsigned(1, v_incoming)) {
+            message = "line " + std::to_string(tokenizer.get_lines() + 1) + ": negative vertex id";
+            return false;
+        }
+
+        EdgeRecord edge;
+        edge.weight = count > 2 ? static_cast<int>(fields[2]) : 0;
+        if (compact) {
+            edge.v_outgoing = list.ids.insert(v_outgoing);
+            edge.v_incoming = list.ids.insert(v_incoming);
+        } else {
+            if (v_outgoing >= INT_MAX || v_incoming >= INT_MAX) {
+                message = "line " + std::to_string(tokenizer.get_lines() + 1) + ": vertex id out of range";
+                return false;
+            }
+            edge.v_outgoing = static_cast<int>(v_outgoing);
+            edge.v_incoming = static_cast<int>(v_incoming);
+            if (edge.v_outgoing >= list.number_of_vertices) list.number_of_vertices = edge.v_outgoing + 1;
+            if (edge.v_incoming >= list.number_of_vertices) list.number_of_vertices = edge.v_incoming + 1;
+        }
+        list.edges.push_back(edge);
+        return true;
+    });
+
+    if (compact) list.number_of_vertices = list.ids.size();
+    if (!result && error) *error = message.empty() ? tokenizer.error() : message;
+    return result;
+}
+#endif
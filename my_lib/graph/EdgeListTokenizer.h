@@ -0,0 +1,514 @@
+#ifndef EDGE_LIST_TOKENIZER_H
+#define EDGE_LIST_TOKENIZER_H
+
+#include "../../include/SDL2/SDL_cpuinfo.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define EDGE_LIST_TOKENIZER_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define EDGE_LIST_TOKENIZER_TARGET(isa) __attribute__((target(isa)))
+#else
+#define EDGE_LIST_TOKENIZER_TARGET(isa)
+#endif
+
+/**
+ * @brief Reader of whitespace/comma separated integer files (the CSV files in res, edge dumps).
+ * @note Every line is handed to the handler as an array of integers. Empty lines are skipped,
+ * @note any character other than a digit, '-', separator (space, tab, ',', ';', '\r') or newline
+ * @note stops reading with an error. A '-' is the sign of the number right after it, so it must
+ * @note be followed by a digit and may not follow one: "1-2", "1 - 2" and "--3" are errors.
+ * @note The file is read in large chunks. Each 64-byte block is classified at once (digits,
+ * @note newlines, invalid characters) into bitmasks with AVX2 or SSE4.2, digit runs are found
+ * @note with bit tricks on these masks and converted with SSE multiply-add instructions.
+ * @note The kernel is chosen at runtime (SDL_HasAVX2/SDL_HasSSE42); the scalar kernel gives
+ * @note the same results on every other CPU.
+ */
+class EdgeListTokenizer {
+    public:
+        enum class Kernel { SCALAR, SSE42, AVX2 };
+
+        static constexpr int MAX_FIELDS = 16; //* maximum number of integers in one line
+
+        EdgeListTokenizer(Kernel kernel = detect_kernel(), size_t chunk_size = 1 << 22)
+            : kernel(kernel), chunk_size(chunk_size < 4096 ? 4096 : chunk_size) {}
+
+        static Kernel detect_kernel();
+        Kernel get_kernel() const { return kernel;}
+
+        /**
+         * @brief Calls handler(const long long *fields, int count) for every non-empty line;
+         * the handler returns false to stop reading.
+         * @note Numbers from -2^63 to 2^64-1 are accepted; fields above INT64_MAX are passed
+         * @note as INT64_MAX, get_unsigned() gives their exact value.
+         * @return true when the whole file has been read without errors
+         */
+        template<typename Handler>
+        bool read(const std::string& filename, Handler&& handler);
+
+        template<typename Handler>
+        bool read(std::FILE *input, Handler&& handler);
+
+        const std::string& error() const { return error_message;}
+        unsigned long long get_lines() const { return lines;} //* number of lines read so far
+
+        //! wartość pola i bieżącej linii (tylko w handlerze) bez znaku; false dla liczby ujemnej
+        bool get_unsigned(int i, unsigned long long& value) const {
+            value = magnitudes[i];
+            return !negative_fields[i];
+        }
+
+    private:
+        static constexpr size_t PADDING = 64;
+        static constexpr size_t WINDOW_BLOCKS = 64; // 4 KB classified at once, stays in L1
+
+        Kernel kernel;
+        size_t chunk_size;
+        std::vector<char> storage;
+        std::string error_message;
+        unsigned long long lines = 0;
+
+        uint64_t digit_masks[WINDOW_BLOCKS];
+        uint64_t newline_masks[WINDOW_BLOCKS];
+        uint64_t invalid_masks[WINDOW_BLOCKS];
+        uint64_t minus_masks[WINDOW_BLOCKS];
+
+        //* tokens of one window: offset of a digit run or a newline, length 0 marks a newline
+        static constexpr size_t MAX_TOKENS = WINDOW_BLOCKS * 64;
+        static constexpr uint8_t TOO_LONG = 0xff; // długość liczby, która nie mieści się w 64 bitach
+        uint16_t token_offsets[MAX_TOKENS + 1];
+        uint8_t token_lengths[MAX_TOKENS + 1];
+        unsigned long long token_values[MAX_TOKENS + 1];
+
+        long long fields[MAX_FIELDS];
+        unsigned long long magnitudes[MAX_FIELDS]; //* wartości bezwzględne pól, również powyżej INT64_MAX
+        bool negative_fields[MAX_FIELDS];
+        int number_of_fields = 0;
+        uint64_t carry = 0;  // czy ostatni bajt poprzedniego bloku był cyfrą
+
+        bool fail(const std::string& message) {
+            error_message = "line " + std::to_string(lines + 1) + ": " + message;
+            return false;
+        }
+
+        void classify(const char *data, size_t blocks);
+        static void classify_scalar(const char *data, size_t blocks, uint64_t *digit, uint64_t *newline, uint64_t *invalid,
+                uint64_t *minus);
+#ifdef EDGE_LIST_TOKENIZER_X86
+        static void classify_sse42(const char *data, size_t blocks, uint64_t *digit, uint64_t *newline, uint64_t *invalid,
+                uint64_t *minus);
+        static void classify_avx2(const char *data, size_t blocks, uint64_t *digit, uint64_t *newline, uint64_t *invalid,
+                uint64_t *minus);
+        static void convert_sse(const char *base, const uint16_t *offsets, const uint8_t *lengths,
+                size_t count, unsigned long long *values);
+#endif
+        static void convert_scalar(const char *base, const uint16_t *offsets, const uint8_t *lengths,
+                size_t count, unsigned long long *values);
+        void convert(const char *base, size_t count);
+
+        size_t collect_tokens(const char *window_data, size_t window_blocks, const char *window_end, size_t& invalid);
+        size_t collect_block(uint16_t *offsets, uint8_t *lengths, size_t count, size_t b, uint64_t digits,
+                uint64_t events, const char *window_data, size_t window_blocks, const char *window_end);
+
+        template<typename Handler>
+        bool process(char *data, size_t size, Handler& handler);
+
+        static int count_trailing_zeros(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctzll(mask);
+#else
+            int count = 0;
+            while (!(mask & 1)) {
+                mask >>= 1;
+                count++;
+            }
+            return count;
+#endif
+        }
+};
+
+EdgeListTokenizer::Kernel EdgeListTokenizer::detect_kernel() {
+#ifdef EDGE_LIST_TOKENIZER_X86
+    if (SDL_HasAVX2()) return Kernel::AVX2;
+    if (SDL_HasSSE42()) return Kernel::SSE42;
+#endif
+    return Kernel::SCALAR;
+}
+
+void EdgeListTokenizer::classify(const char *data, size_t blocks) {
+#ifdef EDGE_LIST_TOKENIZER_X86
+    if (kernel == Kernel::AVX2) return classify_avx2(data, blocks, digit_masks, newline_masks, invalid_masks, minus_masks);
+    if (kernel == Kernel::SSE42) return classify_sse42(data, blocks, digit_masks, newline_masks, invalid_masks, minus_masks);
+#endif
+    classify_scalar(data, blocks, digit_masks, newline_masks, invalid_masks, minus_masks);
+}
+
+void EdgeListTokenizer::classify_scalar(const char *data, size_t blocks,
+        uint64_t *digit, uint64_t *newline, uint64_t *invalid, uint64_t *minus) {
+    for (size_t b = 0; b < blocks; b++, data += 64) {
+        uint64_t d = 0, n = 0, x = 0, m = 0;
+        for (int i = 0; i < 64; i++) {
+            const char c = data[i];
+            const uint64_t bit = uint64_t(1) << i;
+            if (c >= '0' && c <= '9') d |= bit;
+            else if (c == '\n') n |= bit;
+            else if (c == '-') m |= bit;
+            else if (c != ' ' && c != '\t' && c != ',' && c != ';' && c != '\r') x |= bit;
+        }
+        digit[b] = d;
+        newline[b] = n;
+        invalid[b] = x;
+        minus[b] = m;
+    }
+}
+
+#ifdef EDGE_LIST_TOKENIZER_X86
+EDGE_LIST_TOKENIZER_TARGET("sse4.2")
+void EdgeListTokenizer::classify_sse42(const char *data, size_t blocks,
+        uint64_t *digit, uint64_t *newline, uint64_t *invalid, uint64_t *minus) {
+    const __m128i separators = _mm_setr_epi8(' ', '\t', ',', ';', '\r', '-', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i line_feed = _mm_set1_epi8('\n');
+    const __m128i sign = _mm_set1_epi8('-');
+
+    for (size_t b = 0; b < blocks; b++, data += 64) {
+        uint64_t d = 0, n = 0, s = 0, m = 0;
+        for (int part = 0; part < 4; part++) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + part * 16));
+            const __m128i shifted = _mm_sub_epi8(bytes, zero);
+            const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(shifted, nine), shifted);
+            //* PCMPISTRM: which bytes are equal to any of the separators
+            const __m128i is_separator = _mm_cmpistrm(separators, bytes,
+                    _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK);
+
+            d |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(is_digit))) << (part * 16);
+            n |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, line_feed)))) << (part * 16);
+            s |= uint64_t(static_cast<uint16_t>(_mm_cvtsi128_si32(is_separator))) << (part * 16);
+            m |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, sign)))) << (part * 16);
+        }
+        digit[b] = d;
+        newline[b] = n;
+        invalid[b] = ~(d | n | s);
+        minus[b] = m;
+    }
+}
+
+EDGE_LIST_TOKENIZER_TARGET("avx2")
+void EdgeListTokenizer::classify_avx2(const char *data, size_t blocks,
+        uint64_t *digit, uint64_t *newline, uint64_t *invalid, uint64_t *minus) {
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i nine = _mm256_set1_epi8(9);
+    const __m256i line_feed = _mm256_set1_epi8('\n');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i semicolon = _mm256_set1_epi8(';');
+    const __m256i carriage_return = _mm256_set1_epi8('\r');
+    const __m256i sign = _mm256_set1_epi8('-');
+
+    for (size_t b = 0; b < blocks; b++, data += 64) {
+        uint64_t d = 0, n = 0, s = 0, m = 0;
+        for (int part = 0; part < 2; part++) {
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + part * 32));
+            const __m256i shifted = _mm256_sub_epi8(bytes, zero);
+            const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, nine), shifted);
+            const __m256i is_sign = _mm256_cmpeq_epi8(bytes, sign);
+            const __m256i is_separator = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(bytes, space), _mm256_cmpeq_epi8(bytes, tab)),
+                    _mm256_or_si256(
+                        _mm256_or_si256(_mm256_cmpeq_epi8(bytes, comma), _mm256_cmpeq_epi8(bytes, semicolon)),
+                        _mm256_or_si256(_mm256_cmpeq_epi8(bytes, carriage_return), is_sign)));
+
+            d |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(is_digit))) << (part * 32);
+            n |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, line_feed)))) << (part * 32);
+            s |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(is_separator))) << (part * 32);
+            m |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(is_sign))) << (part * 32);
+        }
+        digit[b] = d;
+        newline[b] = n;
+        invalid[b] = ~(d | n | s);
+        minus[b] = m;
+    }
+}
+
+/**
+ * @brief Converts the digit runs of one window, runs of up to 16 digits with SSE.
+ * @note The 16 bytes in front of the end of a run are loaded at once, bytes before the run
+ * @note are masked out and digits are combined pairwise: 2 -> 4 -> 8 digits with
+ * @note PMADDUBSW/PMADDWD, the two 8-digit halves are joined with one scalar multiply.
+ */
+EDGE_LIST_TOKENIZER_TARGET("sse4.2")
+void EdgeListTokenizer::convert_sse(const char *base, const uint16_t *offsets, const uint8_t *lengths,
+        size_t count, unsigned long long *values) {
+    //* loading 16 bytes from masks + length gives 0xff exactly on the last length bytes
+    alignas(16) static const char masks[32] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+    };
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i tens = _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1);
+    const __m128i hundreds = _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1);
+    const __m128i ten_thousands = _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1);
+
+    for (size_t i = 0; i < count; i++) {
+        const int length = lengths[i];
+        const char *start = base + offsets[i];
+        if (length > 16) {
+            if (length == TOO_LONG) continue;
+            unsigned long long value = 0;
+            for (int j = 0; j < length; j++) value = value * 10 + static_cast<unsigned>(start[j] - '0');
+            values[i] = value;
+            continue;
+        }
+
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(start + length - 16));
+        const __m128i inside = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks + length));
+        const __m128i digits = _mm_and_si128(_mm_sub_epi8(bytes, zero), inside);
+
+        const __m128i pairs = _mm_maddubs_epi16(digits, tens);
+        const __m128i quads = _mm_madd_epi16(pairs, hundreds);
+        const __m128i octets = _mm_madd_epi16(_mm_packus_epi32(quads, quads), ten_thousands);
+
+        const unsigned long long high = static_cast<uint32_t>(_mm_cvtsi128_si32(octets));
+        const unsigned long long low = static_cast<uint32_t>(_mm_extract_epi32(octets, 1));
+        values[i] = high * 100000000ULL + low;
+    }
+}
+#endif
+
+void EdgeListTokenizer::convert_scalar(const char *base, const uint16_t *offsets, const uint8_t *lengths,
+        size_t count, unsigned long long *values) {
+    for (size_t i = 0; i < count; i++) {
+        if (lengths[i] == TOO_LONG) continue;
+        const char *start = base + offsets[i];
+        unsigned long long value = 0;
+        for (int j = 0; j < lengths[i]; j++) value = value * 10 + static_cast<unsigned>(start[j] - '0');
+        values[i] = value;
+    }
+}
+
+void EdgeListTokenizer::convert(const char *base, size_t count) {
+#ifdef EDGE_LIST_TOKENIZER_X86
+    if (kernel != Kernel::SCALAR) return convert_sse(base, token_offsets, token_lengths, count, token_values);
+#endif
+    convert_scalar(base, token_offsets, token_lengths, count, token_values);
+}
+
+/**
+ * @brief Appends the events of one block: digit runs with their length and newlines,
+ * which get length 0 for free (a newline is not a digit).
+ * @note Numbers that do not fit in 64 bits (above 18446744073709551615) get length TOO_LONG.
+ */
+size_t EdgeListTokenizer::collect_block(uint16_t *offsets, uint8_t *lengths, size_t count, size_t b,
+        uint64_t digits, uint64_t events, const char *window_data, size_t window_blocks, const char *window_end) {
+    while (events) {
+        const int bit = count_trailing_zeros(events);
+        events &= events - 1;
+
+        size_t length;
+        const uint64_t non_digits = ~digits >> bit;
+        if (non_digits) {
+            length = count_trailing_zeros(non_digits);
+        } else {
+            //* the run continues in the next blocks
+            length = 64 - bit;
+            size_t next = b + 1;
+            for (; next < window_blocks && digit_masks[next] == ~uint64_t(0); next++) length += 64;
+            if (next < window_blocks) {
+                length += count_trailing_zeros(~digit_masks[next]);
+            } else {
+                const char *scan = window_end;
+                while (*scan >= '0' && *scan <= '9') scan++;
+                length = scan - (window_data + b * 64 + bit);
+            }
+        }
+        //* also for runs inside one block: 20 digits and more would wrap around in convert()
+        if (length > 20 || (length == 20 && std::memcmp(window_data + b * 64 + bit, "18446744073709551615", 20) > 0)) {
+            length = TOO_LONG;
+        }
+
+        offsets[count] = static_cast<uint16_t>(b * 64 + bit);
+        lengths[count++] = static_cast<uint8_t>(length);
+    }
+    return count;
+}
+
+/**
+ * @brief Turns the bitmasks of one window into a list of tokens.
+ * @note Stops at the first invalid character or too long number and stores its token index
+ * @note in invalid; invalid stays equal to MAX_TOKENS when the window is correct.
+ */
+size_t EdgeListTokenizer::collect_tokens(const char *window_data, size_t window_blocks, const char *window_end,
+        size_t& invalid) {
+    //* local pointers: stores through uint8_t may alias anything, members would be reloaded after each one
+    uint16_t *offsets = token_offsets;
+    uint8_t *lengths = token_lengths;
+    size_t count = 0;
+    uint64_t previous = carry;
+    invalid = MAX_TOKENS;
+
+    for (size_t b = 0; b < window_blocks; b++) {
+        const uint64_t digits = digit_masks[b];
+        const uint64_t newlines = newline_masks[b];
+        //* a '-' is a sign only right in front of a number and not right behind another one
+        const uint64_t first_digit_after = (b + 1 < window_blocks) ? (digit_masks[b + 1] & 1)
+                : uint64_t(static_cast<unsigned>(*window_end - '0') < 10);
+        const uint64_t digit_after = (digits >> 1) | (first_digit_after << 63);
+        const uint64_t digit_before = (digits << 1) | previous;
+        const uint64_t invalids = invalid_masks[b] | (minus_masks[b] & (~digit_after | digit_before));
+        //* a digit whose predecessor is not a digit starts a new number
+        const uint64_t starts = digits & ~digit_before;
+        previous = digits >> 63;
+
+        if (invalids) {
+            //* report only the tokens in front of the first invalid character
+            const int bit = count_trailing_zeros(invalids);
+            const uint64_t before = (uint64_t(1) << bit) - 1;
+            count = collect_block(offsets, lengths, count, b, digits, (starts | newlines) & before, window_data,
+                    window_blocks, window_end);
+            offsets[count] = static_cast<uint16_t>(b * 64 + bit);
+            invalid = count;
+            carry = previous;
+            return count;
+        }
+
+        count = collect_block(offsets, lengths, count, b, digits, starts | newlines, window_data,
+                window_blocks, window_end);
+    }
+
+    carry = previous;
+    return count;
+}
+
+template<typename Handler>
+bool EdgeListTokenizer::read(const std::string& filename, Handler&& handler) {
+    std::FILE *input = std::fopen(filename.c_str(), "rb");
+    if (!input) {
+        error_message = "can not open " + filename;
+        return false;
+    }
+
+    const bool result = read(input, handler);
+    std::fclose(input);
+    return result;
+}
+
+template<typename Handler>
+bool EdgeListTokenizer::read(std::FILE *input, Handler&& handler) {
+    error_message.clear();
+    lines = 0;
+    number_of_fields = 0;
+    carry = 0;
+
+    size_t capacity = chunk_size;
+    //* PADDING in front: SSE loads may start before the first digit of the chunk
+    //* PADDING behind: room for the final newline and for rounding up to 64-byte blocks
+    storage.assign(PADDING + capacity + PADDING, 0);
+    size_t kept = 0;
+    bool eof = false;
+
+    while (!eof || kept) {
+        char *data = storage.data() + PADDING;
+        size_t size = kept;
+        while (!eof && size < capacity) {
+            const size_t got = std::fread(data + size, 1, capacity - size, input);
+            if (got == 0) eof = true;
+            size += got;
+        }
+        if (size == 0) break;
+
+        size_t end = size;
+        if (eof) {
+            if (data[size - 1] != '\n') data[size++] = '\n';
+            end = size;
+        } else {
+            while (end > kept && data[end - 1] != '\n') end--;
+            if (end == kept && data[end - 1] != '\n') {
+                //* the line does not fit into the buffer - make it bigger and read again
+                capacity *= 2;
+                storage.resize(PADDING + capacity + PADDING, 0);
+                kept = size;
+                continue;
+            }
+        }
+
+        //* process() pads the last block with spaces - keep the beginning of the next line
+        char next_line[64];
+        std::memcpy(next_line, data + end, sizeof(next_line));
+        if (!process(data, end, handler)) return false;
+        std::memcpy(data + end, next_line, sizeof(next_line));
+
+        std::memmove(data, data + end, size - end);
+        kept = size - end;
+    }
+
+    if (std::ferror(input)) {
+        error_message = "read error";
+        return false;
+    }
+    return true;
+}
+
+template<typename Handler>
+bool EdgeListTokenizer::process(char *data, size_t size, Handler& handler) {
+    //* the tail of the last block is filled with separators, so it does not produce tokens
+    const size_t blocks = (size + 63) / 64;
+    std::memset(data + size, ' ', blocks * 64 - size);
+
+    for (size_t window = 0; window < blocks; window += WINDOW_BLOCKS) {
+        const size_t window_blocks = (blocks - window < WINDOW_BLOCKS) ? blocks - window : WINDOW_BLOCKS;
+        const char *window_data = data + window * 64;
+        const char *window_end = window_data + window_blocks * 64;
+
+        classify(window_data, window_blocks);
+        size_t invalid;
+        const size_t count = collect_tokens(window_data, window_blocks, window_end, invalid);
+        convert(window_data, count);
+
+        int used = number_of_fields;
+        for (size_t i = 0; i < count; i++) {
+            if (token_lengths[i] == 0) {
+                if (used) {
+                    if (!handler(static_cast<const long long*>(fields), used)) {
+                        return fail("stopped by the line handler");
+                    }
+                    used = 0;
+                }
+                lines++;
+                continue;
+            }
+
+            const unsigned long long value = token_values[i];
+            //* collect_tokens() has checked the signs, a '-' in front of a number belongs to it
+            const bool negative = window_data[static_cast<std::ptrdiff_t>(token_offsets[i]) - 1] == '-';
+            const unsigned long long limit = negative ? uint64_t(1) << 63 : UINT64_MAX;
+            if (token_lengths[i] == TOO_LONG || value > limit) return fail("number does not fit in 64 bits");
+            if (used == MAX_FIELDS) return fail("too many numbers in one line");
+
+            magnitudes[used] = value;
+            negative_fields[used] = negative;
+            if (negative) fields[used++] = static_cast<long long>(0 - value);
+            else fields[used++] = value > static_cast<unsigned long long>(INT64_MAX) ? INT64_MAX : static_cast<long long>(value);
+        }
+        number_of_fields = used;
+
+        if (invalid != MAX_TOKENS) {
+            const char c = window_data[token_offsets[invalid]];
+            if (c == '-') return fail("'-' not directly in front of a number");
+            return fail(std::string("unexpected character '") + c + "'");
+        }
+    }
+
+    carry = 0; // kawałek zawsze kończy się znakiem nowej linii
+    return true;
+}
+#endif
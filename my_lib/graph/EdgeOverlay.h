@@ -0,0 +1,112 @@
+#ifndef EDGE_OVERLAY_H
+#define EDGE_OVERLAY_H
+
+#include "GraphConcept.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Set of edges removed from a graph that itself is not modified.
+ * @note Open addressing with linear probing over packed (v_outgoing, v_incoming) keys, the table
+ * @note is allocated on the first remove(), so an empty overlay costs nothing and contains()
+ * @note on it is a single comparison.
+ */
+class EdgeOverlay {
+    public:
+        bool empty() const { return number_of_keys == 0;}
+        size_t size() const { return number_of_keys;}
+
+        void clear() {
+            keys.clear();
+            number_of_keys = 0;
+            mask = 0;
+            shift = 64;
+        }
+
+        bool contains(int v_outgoing, int v_incoming) const {
+            if (number_of_keys == 0) return false;
+
+            const uint64_t id = key(v_outgoing, v_incoming);
+            for (size_t slot = home(id); keys[slot] != EMPTY; slot = (slot + 1) & mask) {
+                if (keys[slot] == id) return true;
+            }
+            return false;
+        }
+
+        //! zapamiętuje usunięcie krawędzi, zwraca false, jeśli była już usunięta
+        bool remove(int v_outgoing, int v_incoming) {
+            if (2 * (number_of_keys + 1) > keys.size()) rehash(keys.empty() ? 16 : 2 * keys.size());
+
+            const uint64_t id = key(v_outgoing, v_incoming);
+            size_t slot = home(id);
+            for (; keys[slot] != EMPTY; slot = (slot + 1) & mask) {
+                if (keys[slot] == id) return false;
+            }
+            keys[slot] = id;
+            number_of_keys++;
+            return true;
+        }
+
+    private:
+        static constexpr uint64_t EMPTY = ~uint64_t(0); // wierzchołki mają nieujemne numery, więc to nie jest krawędź
+
+        std::vector<uint64_t> keys;
+        size_t number_of_keys = 0;
+        size_t mask = 0;
+        int shift = 64;
+
+        static uint64_t key(int v_outgoing, int v_incoming) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(v_outgoing)) << 32) | static_cast<uint32_t>(v_incoming);
+        }
+
+        size_t home(uint64_t id) const {
+            return static_cast<size_t>((id * 0x9E3779B97F4A7C15ULL) >> shift) & mask;
+        }
+
+        void rehash(size_t capacity) {
+            std::vector<uint64_t> old(capacity, EMPTY);
+            old.swap(keys);
+            mask = capacity - 1;
+            shift = 64;
+            for (size_t c = capacity; c > 1; c >>= 1) shift--;
+
+            for (uint64_t id : old) {
+                if (id == EMPTY) continue;
+                size_t slot = home(id);
+                while (keys[slot] != EMPTY) slot = (slot + 1) & mask;
+                keys[slot] = id;
+            }
+        }
+};
+
+/**
+ * @brief Copy-on-write view of a graph: the base is only read, removed edges go to an EdgeOverlay.
+ * @note Creating the view costs O(1), so many searches can share one base graph, also from
+ * @note several threads, each with its own OverlayGraph. The base must not change meanwhile
+ * @note (for GraphAsCSR call get_offsets() once before, so pending edges are already merged).
+ */
+template<OutNeighborGraph G>
+class OverlayGraph {
+    public:
+        OverlayGraph(const G& base) : base(base) {}
+
+        int get_number_of_vertices() const { return base.get_number_of_vertices();}
+        int get_number_of_edges() const { return base.get_number_of_edges() - static_cast<int>(removed.size());}
+
+        //! remove_edge należy wołać tylko dla krawędzi, które są w grafie bazowym
+        bool remove_edge(int v_outgoing, int v_incoming) { return removed.remove(v_outgoing, v_incoming);}
+        bool is_removed(int v_outgoing, int v_incoming) const { return removed.contains(v_outgoing, v_incoming);}
+        void restore_all() { removed.clear();}
+
+        template<typename Function>
+        void for_each_out_neighbor(const int vertex, Function&& function) const {
+            base.for_each_out_neighbor(vertex, [&](int v_incoming, int weight) {
+                if (!removed.contains(vertex, v_incoming)) function(v_incoming, weight);
+            });
+        }
+
+    private:
+        const G& base;
+        EdgeOverlay removed;
+};
+#endif
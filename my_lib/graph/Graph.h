@@ -3,16 +3,18 @@
 
 #include "Edge.h"
 #include "Iterator.h"
+#include <functional>
 
 class Graph {
     public:
         using EdgeIterator = Iterator<Edge>;
         using VertexIterator = Iterator<Vertex>;
+        using EdgeVisitor = std::function<void(int v_incoming, int weight)>;
 
         Graph(const int vertex) : number_of_vertices(vertex) {};
-        ~Graph() {};
-        int get_number_of_vertices() { return number_of_vertices;} //* number of vertices in Graph
-        int get_number_of_edges() { return number_of_edges;} //* number of edges in Graph
+        virtual ~Graph() {};
+        int get_number_of_vertices() const { return number_of_vertices;} //* number of vertices in Graph
+        int get_number_of_edges() const { return number_of_edges;} //* number of edges in Graph
 
         virtual void add_edge(int v_outgoing, int v_incoming) = 0; //* create new edge from vertex v_outgoing to v_incoming
         virtual void add_edge(int v_outgoing, int v_incoming, int weight) = 0; //* create new edge from vertex v_outgoing to v_incoming
@@ -22,6 +24,9 @@ class Graph {
         virtual EdgeIterator& edges() = 0; //* return Iterator that goes through all the edges
         virtual EdgeIterator& emanating_edges(const int vertex) = 0; // zwraca iterator przeglądający wszystkie krawędzie wychodzące z podanego wierzchołka
         virtual EdgeIterator& incident_edges(const int vertex) = 0; // zwraca iterator przeglądający wszystkie krawędzie wchodzące do podanego wierzchołka
+        virtual void for_each_emanating(const int vertex, const EdgeVisitor& visitor) const = 0; //* call visitor for every edge going out of vertex, without copying edges
+        virtual void for_each_incident(const int vertex, const EdgeVisitor& visitor) const = 0; //* call visitor(v_outgoing, weight) for every edge coming into vertex
+        virtual void finalize(bool in_neighbors = false) const { (void)in_neighbors;} //* build lazily kept arrays now, after that const reads are safe from many threads
         EdgeIterator& emanating_edges(Vertex &vertex) { return emanating_edges(vertex.get_index());}
         EdgeIterator& incident_edges(Vertex &vertex) { return incident_edges(vertex.get_index());}
     protected:
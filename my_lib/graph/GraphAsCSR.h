@@ -0,0 +1,414 @@
+#ifndef GRAPH_AS_CSR_H
+#define GRAPH_AS_CSR_H
+
+#include "Graph.h"
+#include "GraphConcept.h"
+#include "CompactEdge.h"
+#include "EdgeIndex.h"
+#include "EdgeList.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Graph stored in compressed sparse row form: all edges in one array of CompactEdge<W>,
+ * grouped by source vertex and sorted by target inside every row, offsets[v]..offsets[v + 1] is the row of v.
+ * @note Memory is O(n + m): 4 bytes per edge for W = NoWeight, 8 bytes for int weights,
+ * @note and a row scan touches only consecutive memory.
+ * @note add_edge() collects edges in a pending buffer which is merged into the arrays
+ * @note (one counting sort, O(n + m)) on the next query, so bulk loading stays linear.
+ * @note Edge objects for the Edge* based API are created only on request and are
+ * @note invalidated by the next merge.
+ * @note The transpose (incoming edges) is built on the first in-neighbour query, O(n + m),
+ * @note and dropped by every merge, so graphs that are never walked backwards do not pay for it.
+ * @note Because of both, const queries are not safe from several threads at once until
+ * @note finalize() (finalize(true) for in-neighbour queries) has run after the last add_edge.
+ * @note With enable_edge_index() every edge (pending ones too) is also kept in an EdgeIndex:
+ * @note is_edge() is then one hash probe without merging and find_edge()/select_edge() do not
+ * @note search the row, at the cost of about 16 more bytes per edge.
+ */
+template<typename W = int>
+class BasicGraphAsCSR : public StaticGraph<BasicGraphAsCSR<W>> {
+
+    public:
+        using Edges = std::vector<CompactEdge<W>>;
+        using EdgeIterator = Graph::EdgeIterator;
+        using VertexIterator = Graph::VertexIterator;
+
+        BasicGraphAsCSR(const int n) : StaticGraph<BasicGraphAsCSR<W>>(n), offsets(n + 1, 0) {}
+        BasicGraphAsCSR(const EdgeList& list) : BasicGraphAsCSR(list.number_of_vertices, list.edges) {}
+        BasicGraphAsCSR(const int n, const std::vector<EdgeRecord>& edges);
+
+        BasicGraphAsCSR(BasicGraphAsCSR&&) = default;
+        BasicGraphAsCSR& operator=(BasicGraphAsCSR&&) = default;
+        ~BasicGraphAsCSR() { clear();}
+
+        void clear();
+        void add_edge(int v_outgoing, int v_incoming, int weight) override;
+        void add_edge(int v_outgoing, int v_incoming) override { add_edge(v_outgoing, v_incoming, 0);}
+        bool is_edge(int v_outgoing, int v_incoming) override;
+        Edge* select_edge(int v_outgoing, int v_incoming) const override;
+        template<typename Function>
+        void for_each_out_neighbor(const int vertex, Function&& function) const;
+        template<typename Function>
+        void for_each_in_neighbor(const int vertex, Function&& function) const;
+
+        //! scala oczekujące krawędzie (i buduje transpozycję dla in_neighbors) przed równoległym odczytem
+        void finalize(bool in_neighbors = false) const override {
+            if (in_neighbors) build_transpose(); else merge_pending();
+        }
+
+        int out_degree(const int vertex) const {
+            merge_pending();
+            return offsets[vertex + 1] - offsets[vertex];
+        }
+
+        int in_degree(const int vertex) const {
+            build_transpose();
+            return in_offsets[vertex + 1] - in_offsets[vertex];
+        }
+
+        //* raw arrays, e.g. for algorithms that scan rows directly
+        const std::vector<int>& get_offsets() const { merge_pending(); return offsets;}
+        const Edges& get_adjacency() const { merge_pending(); return adjacency;}
+
+        //! zwraca pozycję krawędzi w tablicy adjacency albo -1
+        int find_edge(int v_outgoing, int v_incoming) const;
+
+        //! włącza (budując go od razu, O(m)) albo usuwa indeks krawędzi
+        void enable_edge_index(bool enabled = true);
+        bool has_edge_index() const { return indexed;}
+        const EdgeIndex& get_edge_index() const { merge_pending(); return edge_index;}
+
+        VertexIterator& vertices() override;
+        EdgeIterator& edges() override;
+        EdgeIterator& emanating_edges(const int vertex) override;
+        EdgeIterator& incident_edges(const int vertex) override;
+
+    private:
+        //* edge added by add_edge and not merged yet
+        struct PendingEdge {
+            int v_outgoing;
+            CompactEdge<W> edge;
+        };
+
+        mutable std::vector<int> offsets;
+        mutable Edges adjacency;
+        mutable std::vector<PendingEdge> pending;
+        std::unordered_set<uint64_t> pending_keys; // krawędzie z pending, żeby nie dodać duplikatu (bez indeksu)
+
+        //* optional index (v_outgoing, v_incoming) -> position in adjacency, PENDING_POSITION for pending edges
+        static constexpr int PENDING_POSITION = -2;
+        bool indexed = false;
+        EdgeIndex edge_index;
+
+        //* transpose, empty until the first in-neighbour query
+        mutable std::vector<int> in_offsets;
+        mutable std::vector<int> in_sources;
+        mutable std::vector<int> in_positions; // pozycja krawędzi w adjacency
+
+        std::vector<Vertex> vertex_storage;
+        std::vector<Vertex*> vertices_list;
+        mutable std::vector<std::unique_ptr<Edge>> edge_views;
+        std::vector<Edge*> edgesContainer;
+
+        static uint64_t key(int v_outgoing, int v_incoming) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(v_outgoing)) << 32) | static_cast<uint32_t>(v_incoming);
+        }
+
+        static int source_of(const EdgeRecord& record) { return record.v_outgoing;}
+        static int source_of(const PendingEdge& record) { return record.v_outgoing;}
+        static CompactEdge<W> edge_of(const EdgeRecord& record) { return CompactEdge<W>(record.v_incoming, W(record.weight));}
+        static CompactEdge<W> edge_of(const PendingEdge& record) { return record.edge;}
+
+        template<typename Record>
+        void build(const std::vector<Record>& records);
+        void merge_pending() const;
+        void build_edge_index();
+        void build_transpose() const;
+        Edge* edge_view(int position, int v_outgoing) const;
+        void ensure_vertices();
+};
+
+using GraphAsCSR = BasicGraphAsCSR<int>;
+using UnweightedGraphAsCSR = BasicGraphAsCSR<NoWeight>;
+
+template<typename W>
+BasicGraphAsCSR<W>::BasicGraphAsCSR(const int n, const std::vector<EdgeRecord>& edges)
+        : StaticGraph<BasicGraphAsCSR<W>>(n), offsets(n + 1, 0) {
+    build(edges);
+}
+
+/**
+ * @brief Counting sort of the edges by source, then every row is sorted by target
+ * and duplicates are dropped (like in GraphAsMatrix, there is at most one edge u -> v).
+ * @note Rows are compacted in place, so the only buffer is the array of edges itself.
+ */
+template<typename W>
+template<typename Record>
+void BasicGraphAsCSR<W>::build(const std::vector<Record>& records) {
+    const int n = this->number_of_vertices;
+    auto valid = [n](int v_outgoing, int v_incoming) {
+        return v_outgoing >= 0 && v_outgoing < n && v_incoming >= 0 && v_incoming < n;
+    };
+
+    std::vector<int> counts(n + 1, 0);
+    for (const Record& record : records) {
+        if (valid(source_of(record), edge_of(record).target)) counts[source_of(record) + 1]++;
+    }
+    for (int v = 0; v < n; v++) counts[v + 1] += counts[v];
+
+    Edges sorted(counts[n]);
+    std::vector<int> next(counts.begin(), counts.end() - 1);
+    for (const Record& record : records) {
+        const CompactEdge<W> edge = edge_of(record);
+        if (valid(source_of(record), edge.target)) sorted[next[source_of(record)]++] = edge;
+    }
+
+    offsets.assign(n + 1, 0);
+    int written = 0;
+    for (int v = 0; v < n; v++) {
+        //* stable sort keeps the first weight of a duplicated edge, as add_edge would
+        std::stable_sort(sorted.begin() + counts[v], sorted.begin() + counts[v + 1],
+                [](const CompactEdge<W>& a, const CompactEdge<W>& b) { return a.target < b.target;});
+        for (int i = counts[v]; i < counts[v + 1]; i++) {
+            if (i > counts[v] && sorted[i].target == sorted[i - 1].target) continue;
+            sorted[written++] = sorted[i];
+        }
+        offsets[v + 1] = written;
+    }
+    sorted.resize(written);
+    sorted.shrink_to_fit();
+    adjacency.swap(sorted);
+
+    this->number_of_edges = written;
+    edge_views.clear();
+    in_offsets.clear();
+    if (indexed) build_edge_index();
+}
+
+//* bulk build: the table is sized once, so no insert rehashes
+template<typename W>
+void BasicGraphAsCSR<W>::build_edge_index() {
+    edge_index.clear();
+    edge_index.reserve(adjacency.size() + pending.size());
+    for (int v = 0; v < this->number_of_vertices; v++) {
+        for (int i = offsets[v]; i < offsets[v + 1]; i++) edge_index.insert(v, adjacency[i].target, i);
+    }
+    for (const PendingEdge& edge : pending) edge_index.insert(edge.v_outgoing, edge.edge.target, PENDING_POSITION);
+}
+
+template<typename W>
+void BasicGraphAsCSR<W>::enable_edge_index(bool enabled) {
+    indexed = enabled;
+    if (enabled) {
+        build_edge_index();
+    } else {
+        edge_index.clear();
+    }
+    //* pending_keys is only kept without the index
+    pending_keys.clear();
+    if (!enabled) {
+        for (const PendingEdge& edge : pending) pending_keys.insert(key(edge.v_outgoing, edge.edge.target));
+    }
+}
+
+template<typename W>
+void BasicGraphAsCSR<W>::merge_pending() const {
+    if (pending.empty()) return;
+
+    BasicGraphAsCSR *self = const_cast<BasicGraphAsCSR*>(this);
+    std::vector<PendingEdge> all;
+    all.reserve(adjacency.size() + pending.size());
+    for (int v = 0; v < this->number_of_vertices; v++) {
+        for (int i = offsets[v]; i < offsets[v + 1]; i++) all.push_back({v, adjacency[i]});
+    }
+    all.insert(all.end(), pending.begin(), pending.end());
+
+    pending.clear();
+    self->pending_keys.clear();
+    self->build(all);
+}
+
+template<typename W>
+void BasicGraphAsCSR<W>::clear() {
+    offsets.assign(this->number_of_vertices + 1, 0);
+    adjacency.clear();
+    pending.clear();
+    pending_keys.clear();
+    edge_index.clear();
+    in_offsets.clear();
+    edge_views.clear();
+    edgesContainer.clear();
+    this->number_of_edges = 0;
+}
+
+template<typename W>
+void BasicGraphAsCSR<W>::add_edge(int v_outgoing, int v_incoming, int weight) {
+    if (v_outgoing < 0 || v_incoming < 0 ||
+        v_outgoing >= this->number_of_vertices || v_incoming >= this->number_of_vertices) return;
+
+    if (indexed) {
+        //* one probe covers both the merged and the pending part
+        if (!edge_index.insert(v_outgoing, v_incoming, PENDING_POSITION)) return;
+        pending.push_back({v_outgoing, CompactEdge<W>(v_incoming, W(weight))});
+        this->number_of_edges++;
+        return;
+    }
+
+    //* the merged part is checked with a binary search, the pending part with a hash set
+    const CompactEdge<W>* row_begin = adjacency.data() + offsets[v_outgoing];
+    const CompactEdge<W>* row_end = adjacency.data() + offsets[v_outgoing + 1];
+    const CompactEdge<W>* found = std::lower_bound(row_begin, row_end, v_incoming,
+            [](const CompactEdge<W>& edge, int target) { return edge.target < target;});
+    if (found != row_end && found->target == v_incoming) return;
+    if (!pending_keys.insert(key(v_outgoing, v_incoming)).second) return;
+
+    pending.push_back({v_outgoing, CompactEdge<W>(v_incoming, W(weight))});
+    this->number_of_edges++;
+}
+
+template<typename W>
+bool BasicGraphAsCSR<W>::is_edge(int v_outgoing, int v_incoming) {
+    //* key(-1, -1) would be the empty slot of the index
+    if (v_outgoing < 0 || v_incoming < 0 ||
+        v_outgoing >= this->number_of_vertices || v_incoming >= this->number_of_vertices) return false;
+    if (indexed) return edge_index.contains(v_outgoing, v_incoming);
+    return find_edge(v_outgoing, v_incoming) >= 0;
+}
+
+template<typename W>
+int BasicGraphAsCSR<W>::find_edge(int v_outgoing, int v_incoming) const {
+    if (v_outgoing < 0 || v_outgoing >= this->number_of_vertices) return -1;
+    merge_pending();
+    if (indexed) return edge_index.find(v_outgoing, v_incoming);
+
+    const CompactEdge<W>* row_begin = adjacency.data() + offsets[v_outgoing];
+    const CompactEdge<W>* row_end = adjacency.data() + offsets[v_outgoing + 1];
+    const CompactEdge<W>* found = std::lower_bound(row_begin, row_end, v_incoming,
+            [](const CompactEdge<W>& edge, int target) { return edge.target < target;});
+    return (found != row_end && found->target == v_incoming) ? static_cast<int>(found - adjacency.data()) : -1;
+}
+
+template<typename W>
+Edge* BasicGraphAsCSR<W>::select_edge(int v_outgoing, int v_incoming) const {
+    const int position = find_edge(v_outgoing, v_incoming);
+    return (position >= 0) ? edge_view(position, v_outgoing) : nullptr;
+}
+
+template<typename W>
+template<typename Function>
+void BasicGraphAsCSR<W>::for_each_out_neighbor(const int vertex, Function&& function) const {
+    if (vertex < 0 || vertex >= this->number_of_vertices) return;
+    merge_pending();
+
+    const CompactEdge<W>* row = adjacency.data();
+    for (int i = offsets[vertex], end = offsets[vertex + 1]; i < end; i++) function(row[i].target, row[i].get_weight());
+}
+
+/**
+ * @brief Counting sort of the edges by target; sources are visited in increasing order,
+ * so every row of the transpose is sorted as well.
+ */
+template<typename W>
+void BasicGraphAsCSR<W>::build_transpose() const {
+    merge_pending();
+    if (!in_offsets.empty()) return;
+
+    const int n = this->number_of_vertices;
+    in_offsets.assign(n + 1, 0);
+    for (const CompactEdge<W>& edge : adjacency) in_offsets[edge.target + 1]++;
+    for (int v = 0; v < n; v++) in_offsets[v + 1] += in_offsets[v];
+
+    in_sources.resize(adjacency.size());
+    in_positions.resize(adjacency.size());
+    std::vector<int> next(in_offsets.begin(), in_offsets.end() - 1);
+    for (int v = 0; v < n; v++) {
+        for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+            const int slot = next[adjacency[i].target]++;
+            in_sources[slot] = v;
+            in_positions[slot] = i;
+        }
+    }
+}
+
+template<typename W>
+template<typename Function>
+void BasicGraphAsCSR<W>::for_each_in_neighbor(const int vertex, Function&& function) const {
+    if (vertex < 0 || vertex >= this->number_of_vertices) return;
+    build_transpose();
+
+    const CompactEdge<W>* edges = adjacency.data();
+    for (int i = in_offsets[vertex], end = in_offsets[vertex + 1]; i < end; i++) {
+        function(in_sources[i], edges[in_positions[i]].get_weight());
+    }
+}
+
+template<typename W>
+void BasicGraphAsCSR<W>::ensure_vertices() {
+    if (static_cast<int>(vertices_list.size()) == this->number_of_vertices) return;
+
+    vertex_storage.clear();
+    vertex_storage.reserve(this->number_of_vertices);
+    vertices_list.clear();
+    for (int i = 0; i < this->number_of_vertices; i++) vertex_storage.emplace_back(i);
+    for (Vertex& vertex : vertex_storage) vertices_list.push_back(&vertex);
+}
+
+//* Edge view of a compact edge, created on the first request
+template<typename W>
+Edge* BasicGraphAsCSR<W>::edge_view(int position, int v_outgoing) const {
+    if (edge_views.size() != adjacency.size()) edge_views.resize(adjacency.size());
+    if (!edge_views[position]) {
+        const_cast<BasicGraphAsCSR*>(this)->ensure_vertices();
+        const CompactEdge<W>& edge = adjacency[position];
+        edge_views[position].reset(new Edge(vertices_list[v_outgoing], vertices_list[edge.target], edge.get_weight()));
+    }
+    return edge_views[position].get();
+}
+
+template<typename W>
+typename BasicGraphAsCSR<W>::VertexIterator& BasicGraphAsCSR<W>::vertices() {
+    ensure_vertices();
+    VertexIterator *itr = new VertexIterator(vertices_list.data());
+    return *itr;
+}
+
+template<typename W>
+typename BasicGraphAsCSR<W>::EdgeIterator& BasicGraphAsCSR<W>::edges() {
+    merge_pending();
+    edgesContainer.clear();
+    for (int v = 0; v < this->number_of_vertices; v++) {
+        for (int i = offsets[v]; i < offsets[v + 1]; i++) edgesContainer.push_back(edge_view(i, v));
+    }
+
+    EdgeIterator *itr = new EdgeIterator(edgesContainer.data());
+    return *itr;
+}
+
+//! zwraca iterator przeglądający wszystkie krawędzie wychodzące z podanego wierzchołka
+template<typename W>
+typename BasicGraphAsCSR<W>::EdgeIterator& BasicGraphAsCSR<W>::emanating_edges(const int vertex) {
+    merge_pending();
+    edgesContainer.clear();
+    for (int i = offsets[vertex]; i < offsets[vertex + 1]; i++) edgesContainer.push_back(edge_view(i, vertex));
+
+    EdgeIterator *itr = new EdgeIterator(edgesContainer.data());
+    return *itr;
+}
+
+//! zwraca iterator przeglądający wszystkie krawędzie wchodzące do podanego wierzchołka
+template<typename W>
+typename BasicGraphAsCSR<W>::EdgeIterator& BasicGraphAsCSR<W>::incident_edges(const int vertex) {
+    build_transpose();
+    edgesContainer.clear();
+    for (int i = in_offsets[vertex]; i < in_offsets[vertex + 1]; i++) {
+        edgesContainer.push_back(edge_view(in_positions[i], in_sources[i]));
+    }
+
+    EdgeIterator *itr = new EdgeIterator(edgesContainer.data());
+    return *itr;
+}
+#endif
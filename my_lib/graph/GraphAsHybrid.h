@@ -0,0 +1,380 @@
+#ifndef GRAPH_AS_HYBRID_H
+#define GRAPH_AS_HYBRID_H
+
+#include "Graph.h"
+#include "GraphConcept.h"
+#include "GraphAsCSR.h"
+#include "DynamicBitset.h"
+#include "EdgeList.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Graph with a per-row layout: rows of hubs are bitsets of n bits (is_edge is one bit test),
+ * all other rows are sorted arrays of targets like in GraphAsCSR.
+ * @note A row becomes a bitset when it is not larger than the array, that is from
+ * @note dense_degree = 2 * words + blocks out-neighbours (default_dense_degree); dense_degree = 1
+ * @note turns every non-empty row into a bitset (a plain bit matrix without the empty rows).
+ * @note Every edge has an id: edge_offsets[v] + its rank in the row. Weights are kept by id and
+ * @note only if some weight is not 0; the rank inside a bitset row is a prefix count stored
+ * @note for every RANK_BLOCK words plus a few popcounts.
+ * @note Like GraphAsCSR, add_edge() collects edges which are merged (the layout is rebuilt)
+ * @note on the next query, and the transpose is built on the first in-neighbour query, so
+ * @note concurrent const queries need finalize() (finalize(true) for in-neighbours) first.
+ */
+class GraphAsHybrid : public StaticGraph<GraphAsHybrid> {
+
+    public:
+        static constexpr int RANK_BLOCK = 8; //* words of a bitset row per stored prefix count
+
+        GraphAsHybrid(const int n, const std::vector<EdgeRecord>& edges, const int dense_degree = 0);
+        GraphAsHybrid(const EdgeList& list, const int dense_degree = 0)
+                : GraphAsHybrid(list.number_of_vertices, list.edges, dense_degree) {}
+        GraphAsHybrid(const int n) : GraphAsHybrid(n, std::vector<EdgeRecord>()) {}
+        ~GraphAsHybrid() { clear();}
+
+        //! najmniejszy stopień, przy którym bitset nie zajmuje więcej niż tablica sąsiadów
+        static int default_dense_degree(const int n) {
+            const int words = (n + 63) / 64;
+            return std::max(1, 2 * words + (words + RANK_BLOCK - 1) / RANK_BLOCK);
+        }
+
+        void clear();
+        void add_edge(int v_outgoing, int v_incoming, int weight) override;
+        void add_edge(int v_outgoing, int v_incoming) override { add_edge(v_outgoing, v_incoming, 0);}
+        bool is_edge(int v_outgoing, int v_incoming) override { return find_edge(v_outgoing, v_incoming) >= 0;}
+        Edge* select_edge(int v_outgoing, int v_incoming) const override;
+        template<typename Function>
+        void for_each_out_neighbor(const int vertex, Function&& function) const;
+        template<typename Function>
+        void for_each_in_neighbor(const int vertex, Function&& function) const;
+
+        //! scala oczekujące krawędzie (i buduje transpozycję dla in_neighbors) przed równoległym odczytem
+        void finalize(bool in_neighbors = false) const override {
+            if (in_neighbors) build_transpose(); else merge_pending();
+        }
+
+        int out_degree(const int vertex) const {
+            merge_pending();
+            return edge_offsets[vertex + 1] - edge_offsets[vertex];
+        }
+        bool is_dense_row(const int vertex) const { merge_pending(); return dense_index[vertex] >= 0;}
+        int get_dense_rows() const { merge_pending(); return number_of_dense_rows;}
+        int get_dense_degree() const { return dense_degree;}
+        size_t memory_usage() const; //* bytes of the adjacency arrays (without Edge views and transpose)
+
+        //! zwraca numer krawędzi albo -1
+        int find_edge(int v_outgoing, int v_incoming) const;
+
+        VertexIterator& vertices() override;
+        EdgeIterator& edges() override;
+        EdgeIterator& emanating_edges(const int vertex) override;
+        EdgeIterator& incident_edges(const int vertex) override;
+
+    private:
+        int dense_degree;
+        int words_per_row;
+        int blocks_per_row;
+        int number_of_dense_rows = 0;
+
+        mutable std::vector<int> edge_offsets;   // numery krawędzi wiersza v: edge_offsets[v]..edge_offsets[v + 1]
+        mutable std::vector<int> dense_index;    // numer wiersza w bits albo -1 dla wiersza rzadkiego
+        mutable std::vector<int> target_offsets; // wiersze rzadkie w targets (puste dla gęstych)
+        mutable std::vector<int> targets;
+        mutable std::vector<uint64_t> bits;
+        mutable std::vector<uint32_t> ranks;     // liczba krawędzi w wierszu przed każdym blokiem RANK_BLOCK słów
+        mutable std::vector<int> weights;        // waga krawędzi o danym numerze, puste gdy wszystkie są 0
+        mutable std::vector<EdgeRecord> pending;
+        std::unordered_set<uint64_t> pending_keys;
+
+        mutable std::vector<int> in_offsets;
+        mutable std::vector<int> in_sources;
+        mutable std::vector<int> in_edges;       // numery krawędzi
+
+        std::vector<Vertex> vertex_storage;
+        std::vector<Vertex*> vertices_list;
+        mutable std::vector<std::unique_ptr<Edge>> edge_views;
+        std::vector<Edge*> edgesContainer;
+
+        static uint64_t key(int v_outgoing, int v_incoming) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(v_outgoing)) << 32) | static_cast<uint32_t>(v_incoming);
+        }
+
+        int weight_of(int edge) const { return weights.empty() ? 0 : weights[edge];}
+        const uint64_t* dense_row(int vertex) const { return bits.data() + static_cast<size_t>(dense_index[vertex]) * words_per_row;}
+
+        void build(const std::vector<EdgeRecord>& edges);
+        void merge_pending() const;
+        template<typename Function>
+        void for_each_row(const int vertex, Function&& function) const;
+        int find_merged_edge(int v_outgoing, int v_incoming) const;
+        void build_transpose() const;
+        Edge* edge_view(int edge, int v_outgoing, int v_incoming) const;
+        void ensure_vertices();
+};
+
+GraphAsHybrid::GraphAsHybrid(const int n, const std::vector<EdgeRecord>& edges, const int dense_degree)
+        : StaticGraph(n), dense_degree(dense_degree > 0 ? dense_degree : default_dense_degree(n)),
+          words_per_row((n + 63) / 64), blocks_per_row((words_per_row + RANK_BLOCK - 1) / RANK_BLOCK) {
+    build(edges);
+}
+
+/**
+ * @brief Sorts and deduplicates the edges through a temporary GraphAsCSR, then moves
+ * every row either to the bitsets or to the targets array.
+ */
+void GraphAsHybrid::build(const std::vector<EdgeRecord>& edges) {
+    const int n = this->number_of_vertices;
+    const GraphAsCSR sorted(n, edges);
+    const std::vector<int>& offsets = sorted.get_offsets();
+    const std::vector<CompactEdge<int>>& adjacency = sorted.get_adjacency();
+
+    edge_offsets = offsets;
+    dense_index.assign(n, -1);
+    number_of_dense_rows = 0;
+    for (int v = 0; v < n; v++) {
+        if (offsets[v + 1] - offsets[v] >= dense_degree) dense_index[v] = number_of_dense_rows++;
+    }
+
+    bits.assign(static_cast<size_t>(number_of_dense_rows) * words_per_row, 0);
+    ranks.assign(static_cast<size_t>(number_of_dense_rows) * blocks_per_row, 0);
+    target_offsets.assign(n + 1, 0);
+    targets.clear();
+    for (int v = 0; v < n; v++) {
+        if (dense_index[v] < 0) {
+            for (int i = offsets[v]; i < offsets[v + 1]; i++) targets.push_back(adjacency[i].target);
+        } else {
+            uint64_t *row = bits.data() + static_cast<size_t>(dense_index[v]) * words_per_row;
+            for (int i = offsets[v]; i < offsets[v + 1]; i++) row[adjacency[i].target >> 6] |= uint64_t(1) << (adjacency[i].target & 63);
+
+            uint32_t *row_ranks = ranks.data() + static_cast<size_t>(dense_index[v]) * blocks_per_row;
+            uint32_t count = 0;
+            for (int w = 0; w < words_per_row; w++) {
+                if (w % RANK_BLOCK == 0) row_ranks[w / RANK_BLOCK] = count;
+                count += DynamicBitset::popcount(row[w]);
+            }
+        }
+        target_offsets[v + 1] = static_cast<int>(targets.size());
+    }
+    targets.shrink_to_fit();
+
+    //* rows are sorted by target, so the position in the CSR is also the rank in a bitset row
+    weights.clear();
+    const bool weighted = std::any_of(adjacency.begin(), adjacency.end(),
+            [](const CompactEdge<int>& edge) { return edge.weight != 0;});
+    if (weighted) {
+        weights.resize(adjacency.size());
+        for (size_t i = 0; i < adjacency.size(); i++) weights[i] = adjacency[i].weight;
+    }
+
+    this->number_of_edges = static_cast<int>(adjacency.size());
+    edge_views.clear();
+    in_offsets.clear();
+}
+
+void GraphAsHybrid::merge_pending() const {
+    if (pending.empty()) return;
+
+    GraphAsHybrid *self = const_cast<GraphAsHybrid*>(this);
+    std::vector<EdgeRecord> all;
+    all.reserve(this->number_of_edges);
+    for (int v = 0; v < this->number_of_vertices; v++) {
+        for_each_row(v, [&all, v](int v_incoming, int weight) { all.push_back({v, v_incoming, weight});});
+    }
+    all.insert(all.end(), pending.begin(), pending.end());
+
+    pending.clear();
+    self->pending_keys.clear();
+    self->build(all);
+}
+
+void GraphAsHybrid::clear() {
+    edge_offsets.assign(this->number_of_vertices + 1, 0);
+    dense_index.assign(this->number_of_vertices, -1);
+    target_offsets.assign(this->number_of_vertices + 1, 0);
+    targets.clear();
+    bits.clear();
+    ranks.clear();
+    weights.clear();
+    pending.clear();
+    pending_keys.clear();
+    in_offsets.clear();
+    edge_views.clear();
+    edgesContainer.clear();
+    number_of_dense_rows = 0;
+    this->number_of_edges = 0;
+}
+
+void GraphAsHybrid::add_edge(int v_outgoing, int v_incoming, int weight) {
+    if (v_outgoing < 0 || v_incoming < 0 ||
+        v_outgoing >= this->number_of_vertices || v_incoming >= this->number_of_vertices) return;
+
+    if (find_merged_edge(v_outgoing, v_incoming) >= 0) return;
+    if (!pending_keys.insert(key(v_outgoing, v_incoming)).second) return;
+
+    pending.push_back({v_outgoing, v_incoming, weight});
+    this->number_of_edges++;
+}
+
+//* looks only at the built layout, pending edges are not merged
+int GraphAsHybrid::find_merged_edge(int v_outgoing, int v_incoming) const {
+    if (v_outgoing < 0 || v_outgoing >= this->number_of_vertices ||
+        v_incoming < 0 || v_incoming >= this->number_of_vertices) return -1;
+
+    if (dense_index[v_outgoing] >= 0) {
+        const uint64_t *row = dense_row(v_outgoing);
+        const int word = v_incoming >> 6;
+        const uint64_t below = (uint64_t(1) << (v_incoming & 63)) - 1;
+        if (!((row[word] >> (v_incoming & 63)) & 1)) return -1;
+
+        int rank = ranks[static_cast<size_t>(dense_index[v_outgoing]) * blocks_per_row + word / RANK_BLOCK];
+        for (int w = word - word % RANK_BLOCK; w < word; w++) rank += DynamicBitset::popcount(row[w]);
+        rank += DynamicBitset::popcount(row[word] & below);
+        return edge_offsets[v_outgoing] + rank;
+    }
+
+    const int *row_begin = targets.data() + target_offsets[v_outgoing];
+    const int *row_end = targets.data() + target_offsets[v_outgoing + 1];
+    const int *found = std::lower_bound(row_begin, row_end, v_incoming);
+    return (found != row_end && *found == v_incoming) ? edge_offsets[v_outgoing] + static_cast<int>(found - row_begin) : -1;
+}
+
+int GraphAsHybrid::find_edge(int v_outgoing, int v_incoming) const {
+    merge_pending();
+    return find_merged_edge(v_outgoing, v_incoming);
+}
+
+Edge* GraphAsHybrid::select_edge(int v_outgoing, int v_incoming) const {
+    const int edge = find_edge(v_outgoing, v_incoming);
+    return (edge >= 0) ? edge_view(edge, v_outgoing, v_incoming) : nullptr;
+}
+
+//* visits the built row of vertex, bitset rows by increasing target as well
+template<typename Function>
+void GraphAsHybrid::for_each_row(const int vertex, Function&& function) const {
+    int edge = edge_offsets[vertex];
+    if (dense_index[vertex] >= 0) {
+        const uint64_t *row = dense_row(vertex);
+        for (int w = 0; w < words_per_row; w++) {
+            for (uint64_t word = row[w]; word; word &= word - 1) {
+                function(w * 64 + DynamicBitset::lowest_bit(word), weight_of(edge++));
+            }
+        }
+        return;
+    }
+
+    for (int i = target_offsets[vertex], end = target_offsets[vertex + 1]; i < end; i++) {
+        function(targets[i], weight_of(edge++));
+    }
+}
+
+template<typename Function>
+void GraphAsHybrid::for_each_out_neighbor(const int vertex, Function&& function) const {
+    if (vertex < 0 || vertex >= this->number_of_vertices) return;
+    merge_pending();
+    for_each_row(vertex, function);
+}
+
+size_t GraphAsHybrid::memory_usage() const {
+    merge_pending();
+    return (edge_offsets.size() + dense_index.size() + target_offsets.size() + targets.size() + weights.size()) * sizeof(int) +
+            bits.size() * sizeof(uint64_t) + ranks.size() * sizeof(uint32_t);
+}
+
+void GraphAsHybrid::build_transpose() const {
+    merge_pending();
+    if (!in_offsets.empty()) return;
+
+    const int n = this->number_of_vertices;
+    in_offsets.assign(n + 1, 0);
+    for (int v = 0; v < n; v++) {
+        for_each_row(v, [this](int v_incoming, int) { in_offsets[v_incoming + 1]++;});
+    }
+    for (int v = 0; v < n; v++) in_offsets[v + 1] += in_offsets[v];
+
+    in_sources.resize(this->number_of_edges);
+    in_edges.resize(this->number_of_edges);
+    std::vector<int> next(in_offsets.begin(), in_offsets.end() - 1);
+    for (int v = 0; v < n; v++) {
+        int edge = edge_offsets[v];
+        for_each_row(v, [&](int v_incoming, int) {
+            const int slot = next[v_incoming]++;
+            in_sources[slot] = v;
+            in_edges[slot] = edge++;
+        });
+    }
+}
+
+template<typename Function>
+void GraphAsHybrid::for_each_in_neighbor(const int vertex, Function&& function) const {
+    if (vertex < 0 || vertex >= this->number_of_vertices) return;
+    build_transpose();
+
+    for (int i = in_offsets[vertex], end = in_offsets[vertex + 1]; i < end; i++) {
+        function(in_sources[i], weight_of(in_edges[i]));
+    }
+}
+
+void GraphAsHybrid::ensure_vertices() {
+    if (static_cast<int>(vertices_list.size()) == this->number_of_vertices) return;
+
+    vertex_storage.clear();
+    vertex_storage.reserve(this->number_of_vertices);
+    vertices_list.clear();
+    for (int i = 0; i < this->number_of_vertices; i++) vertex_storage.emplace_back(i);
+    for (Vertex& vertex : vertex_storage) vertices_list.push_back(&vertex);
+}
+
+Edge* GraphAsHybrid::edge_view(int edge, int v_outgoing, int v_incoming) const {
+    if (static_cast<int>(edge_views.size()) != this->number_of_edges) edge_views.resize(this->number_of_edges);
+    if (!edge_views[edge]) {
+        const_cast<GraphAsHybrid*>(this)->ensure_vertices();
+        edge_views[edge].reset(new Edge(vertices_list[v_outgoing], vertices_list[v_incoming], weight_of(edge)));
+    }
+    return edge_views[edge].get();
+}
+
+GraphAsHybrid::VertexIterator& GraphAsHybrid::vertices() {
+    ensure_vertices();
+    VertexIterator *itr = new VertexIterator(vertices_list.data());
+    return *itr;
+}
+
+GraphAsHybrid::EdgeIterator& GraphAsHybrid::edges() {
+    merge_pending();
+    edgesContainer.clear();
+    for (int v = 0; v < this->number_of_vertices; v++) {
+        int edge = edge_offsets[v];
+        for_each_row(v, [&](int v_incoming, int) { edgesContainer.push_back(edge_view(edge++, v, v_incoming));});
+    }
+
+    EdgeIterator *itr = new EdgeIterator(edgesContainer.data());
+    return *itr;
+}
+
+//! zwraca iterator przeglądający wszystkie krawędzie wychodzące z podanego wierzchołka
+GraphAsHybrid::EdgeIterator& GraphAsHybrid::emanating_edges(const int vertex) {
+    merge_pending();
+    edgesContainer.clear();
+    int edge = edge_offsets[vertex];
+    for_each_row(vertex, [&](int v_incoming, int) { edgesContainer.push_back(edge_view(edge++, vertex, v_incoming));});
+
+    EdgeIterator *itr = new EdgeIterator(edgesContainer.data());
+    return *itr;
+}
+
+//! zwraca iterator przeglądający wszystkie krawędzie wchodzące do podanego wierzchołka
+GraphAsHybrid::EdgeIterator& GraphAsHybrid::incident_edges(const int vertex) {
+    build_transpose();
+    edgesContainer.clear();
+    for (int i = in_offsets[vertex]; i < in_offsets[vertex + 1]; i++) {
+        edgesContainer.push_back(edge_view(in_edges[i], in_sources[i], vertex));
+    }
+
+    EdgeIterator *itr = new EdgeIterator(edgesContainer.data());
+    return *itr;
+}
+#endif
@@ -2,14 +2,20 @@
 #define GRAPH_AS_MATRIX_H
 
 #include "Graph.h"
+#include "GraphConcept.h"
+#include "GraphDump.h"
+#include "Traversal.h"
+#include "EdgeListTokenizer.h"
+#include "EdgeList.h"
+#include "DynamicBitset.h"
+#include "TiledMatrix.h"
 #include <vector>
-#include <set>
 #include <algorithm>
 #include <stack>
 #include <chrono>
 #include <iomanip>
 #include <fstream>
-#include <sstream>
+#include <climits>
 
 namespace Color {
     enum Code {
@@ -30,7 +36,7 @@ namespace Color {
     };
 }
 
-class GraphAsMatrix : public Graph {
+class GraphAsMatrix : public StaticGraph<GraphAsMatrix> {
     
     public:
         GraphAsMatrix(const int n);
@@ -39,25 +45,39 @@ class GraphAsMatrix : public Graph {
             readData(filename);
         }
 
+        //! wczytanie całej listy naraz: bez Log::Info dla każdej krawędzi i bez czyszczenia Logi.txt
+        GraphAsMatrix(const EdgeList& list);
+
         ~GraphAsMatrix() { clear();}
 
         void clear();
         void add_edge(int v_outgoing, int v_incoming, int weight) override;
         void add_edge(int v_outgoing, int v_incoming) override { add_edge(v_outgoing, v_incoming, 0);}
-        int get_all_vertex() { return numberOfAllVertex.size();}
+        int get_all_vertex() { return static_cast<int>(numberOfAllVertex.count());}
         bool is_edge(int v_outgoing, int v_incoming) override { return (select_edge(v_outgoing, v_incoming)) ? true : false;}
         Vertex* select_vertex(int idx) { if (idx < this->number_of_vertices) return vertices_list[idx];}
         Edge* select_edge(int v_outgoing, int v_incoming) const {
             return (v_outgoing < this->number_of_vertices && v_incoming < this->number_of_vertices) ?
-                    adjacency_matrix[v_outgoing][v_incoming] : nullptr;
+                    adjacency_matrix.get(v_outgoing, v_incoming) : nullptr;
         }
+        template<typename Function>
+        void for_each_out_neighbor(const int vertex, Function&& function) const;
+        template<typename Function>
+        void for_each_in_neighbor(const int vertex, Function&& function) const;
+        int in_degree(const int vertex) const { return static_cast<int>(incoming[vertex].size());}
         std::vector<std::vector<int>> find_cycles();
+        void displayEdges(const DumpOptions& options);
+        bool dump(const std::string& filename, const DumpOptions& options = DumpOptions()) const;
         class Log;
+
+        //* number of rows shown in the console/Logi.txt preview after readData
+        static constexpr int DISPLAY_ROWS_LIMIT = 32;
     private:
         std::vector<Vertex *> vertices_list;
-        std::vector<std::vector<Edge*>> adjacency_matrix;
+        TiledMatrix<Edge*> adjacency_matrix; //* 64 x 64 tiles allocated on the first edge inside
+        std::vector<std::vector<int>> incoming; //* transpose: sources of the edges coming into every vertex, in order of adding
         std::vector<Edge*> edgesContainer;
-        std::set<int> numberOfAllVertex;
+        DynamicBitset numberOfAllVertex; //* vertices that have at least one edge
 
         VertexIterator& vertices() override;
         EdgeIterator& edges() override;
@@ -70,11 +90,9 @@ class GraphAsMatrix : public Graph {
         VertexIterator& end();
         EdgeIterator& end(int i);
         
-        void displayEdges();
+        //! add_edge bez wpisu do logu, dla wczytywania wielu krawędzi naraz
+        void insert_edge(int v_outgoing, int v_incoming, int weight);
         void readData(const std::string& filename);
-        void dfs(std::vector<std::vector<Edge*>>& adjacency_matrix_copy, int v,
-                std::vector<int>& path, std::vector<bool>& visited,
-                Edge* lastEdge, std::vector<std::vector<int>>& cycles);
 };
 
 class GraphAsMatrix::Log {
@@ -127,22 +145,12 @@ std::string GraphAsMatrix::Log::currentDateTime() {
     return buf;
 }
 
-GraphAsMatrix::GraphAsMatrix(const int n) : vertices_list(n), adjacency_matrix(n), Graph(n) {
+GraphAsMatrix::GraphAsMatrix(const int n) : StaticGraph(n), vertices_list(n), adjacency_matrix(n), incoming(n), numberOfAllVertex(n) {
     Log::Info("Create Graph with size = " + std::to_string(n));
-    for (unsigned int i = 0; i < n; i++) {
+    for (int i = 0; i < n; i++) {
         vertices_list[i] = new Vertex(i);
     }
 
-    for (unsigned int i = 0; i < n; i++) {
-        adjacency_matrix[i].resize(n);
-    }
-
-    for (unsigned int i = 0; i < n; i++) {
-        for (unsigned int j = 0; j < n; j++) {
-            adjacency_matrix[i][j] = nullptr; 
-        }
-    }
-
     // czyszczenie pliku Logi.txt
     std::ofstream file("Logi.txt", std::ios::trunc);
 
@@ -154,19 +162,28 @@ GraphAsMatrix::GraphAsMatrix(const int n) : vertices_list(n), adjacency_matrix(n
     file.close();
 }
 
+GraphAsMatrix::GraphAsMatrix(const EdgeList& list) : StaticGraph(list.number_of_vertices),
+        vertices_list(list.number_of_vertices), adjacency_matrix(list.number_of_vertices),
+        incoming(list.number_of_vertices), numberOfAllVertex(list.number_of_vertices) {
+    for (int i = 0; i < list.number_of_vertices; i++) {
+        vertices_list[i] = new Vertex(i);
+    }
+    for (const EdgeRecord& edge : list.edges) {
+        insert_edge(edge.v_outgoing, edge.v_incoming, edge.weight);
+    }
+}
+
 void GraphAsMatrix::clear() {
     for (Vertex *vertex : vertices_list) {
         delete vertex;
     }
     vertices_list.clear();
 
-    for (std::vector<Edge *> &row : adjacency_matrix) {
-        for (Edge *edge : row) {
-            delete edge;
-        }
-        row.clear();
-    }
+    adjacency_matrix.for_each_cell([](Edge *edge) {
+        delete edge;
+    });
     adjacency_matrix.clear();
+    incoming.clear();
 
     if (edgesContainer.size() != 0) {
         for (Edge *edge : edgesContainer) {
@@ -179,28 +196,27 @@ void GraphAsMatrix::clear() {
 
 void GraphAsMatrix::add_edge(int v_outgoing, int v_incoming, int weight) {
     Log::Info("Adding edge (" + std::to_string(v_outgoing) + ", " + std::to_string(v_incoming) + ")");
-    if (v_outgoing < this->number_of_vertices && v_incoming < this->number_of_vertices) {
-        if (!adjacency_matrix[v_outgoing][v_incoming]) {
-            adjacency_matrix[v_outgoing][v_incoming] =
-                    new Edge(vertices_list[v_outgoing], vertices_list[v_incoming], weight);
+    insert_edge(v_outgoing, v_incoming, weight);
+}
+
+//* edges with a vertex outside of the graph are skipped
+void GraphAsMatrix::insert_edge(int v_outgoing, int v_incoming, int weight) {
+    if (v_outgoing >= 0 && v_incoming >= 0 &&
+            v_outgoing < this->number_of_vertices && v_incoming < this->number_of_vertices) {
+        Edge *&cell = adjacency_matrix.at(v_outgoing, v_incoming);
+        if (!cell) {
+            cell = new Edge(vertices_list[v_outgoing], vertices_list[v_incoming], weight);
+            incoming[v_incoming].push_back(v_outgoing);
             this->number_of_edges++;
-            numberOfAllVertex.insert(v_outgoing);
-            numberOfAllVertex.insert(v_incoming);
+            numberOfAllVertex.set(v_outgoing);
+            numberOfAllVertex.set(v_incoming);
         }
     }  
 }
 
 std::vector<std::vector<int>> GraphAsMatrix::find_cycles() {
-    std::vector<std::vector<Edge*>> adjacency_matrix_copy = adjacency_matrix;
-    std::vector<std::vector<int>> cycles;
-
-    for (int v = 0; v < number_of_vertices; v++) {
-        std::vector<int> path;
-        std::vector<bool> visited(number_of_vertices, false);
-        Edge *lastEdge = nullptr;
-
-        dfs(adjacency_matrix_copy, v, path, visited, lastEdge, cycles);
-    }
+    //* used edges are hidden by an overlay instead of nulling them in a copy of the matrix
+    std::vector<std::vector<int>> cycles = CycleFinder<GraphAsMatrix>(*this).find();
 
     Log::Info("Display cycles");
     std::ofstream file("Logi.txt", std::ios::app);
@@ -241,10 +257,10 @@ GraphAsMatrix::VertexIterator& GraphAsMatrix::vertices() {
 
 GraphAsMatrix::EdgeIterator& GraphAsMatrix::edges() {
     edgesContainer.clear();
-    for (std::vector<Edge*> vector : adjacency_matrix) {
-        for (Edge *edge : vector) {
-            if (edge) edgesContainer.push_back(edge);
-        }
+    for (int v = 0; v < this->number_of_vertices; v++) {
+        adjacency_matrix.for_each_in_row(v, [this](int, Edge *edge) {
+            edgesContainer.push_back(edge);
+        });
     }
 
     EdgeIterator *itr = new EdgeIterator(edgesContainer.data());
@@ -255,19 +271,20 @@ GraphAsMatrix::EdgeIterator& GraphAsMatrix::edges() {
 GraphAsMatrix::EdgeIterator& GraphAsMatrix::emanating_edges(const int vertex) {
 
     edgesContainer.clear();
-    for (Edge* edge : adjacency_matrix[vertex]) {
-        if (edge) edgesContainer.push_back(edge);
-    }
+    adjacency_matrix.for_each_in_row(vertex, [this](int, Edge *edge) {
+        edgesContainer.push_back(edge);
+    });
 
     EdgeIterator *itr = new EdgeIterator(edgesContainer.data());
     return *itr;
 }
 
 //! zwraca iterator przeglądający wszystkie krawędzie wchodzące do podanego wierzchołka
+//* O(in-degree) thanks to the transpose, edges come in the order they were added
 GraphAsMatrix::EdgeIterator& GraphAsMatrix::incident_edges(const int vertex) {
     edgesContainer.clear();
-    for (size_t i = 0; i < adjacency_matrix.size(); i++) {
-        if (adjacency_matrix[i][vertex]) edgesContainer.push_back(adjacency_matrix[i][vertex]);
+    for (int v_outgoing : incoming[vertex]) {
+        edgesContainer.push_back(adjacency_matrix.get(v_outgoing, vertex));
     }
 
     EdgeIterator *itr = new EdgeIterator(edgesContainer.data());
@@ -281,7 +298,12 @@ GraphAsMatrix::VertexIterator& GraphAsMatrix::begin() {
 
 GraphAsMatrix::EdgeIterator GraphAsMatrix::begin(int raw_idx) {
     if (raw_idx < number_of_vertices) {
-        return EdgeIterator(&adjacency_matrix[raw_idx][0]);
+        //* rows are not contiguous in tiles, so the edges of the row are gathered first
+        edgesContainer.clear();
+        adjacency_matrix.for_each_in_row(raw_idx, [this](int, Edge *edge) {
+            edgesContainer.push_back(edge);
+        });
+        return EdgeIterator(edgesContainer.data());
     }
     return EdgeIterator(nullptr);
 }
@@ -292,91 +314,95 @@ GraphAsMatrix::VertexIterator& GraphAsMatrix::end() {
     return *itr;
 }
 
-GraphAsMatrix::EdgeIterator& GraphAsMatrix::end(int i) {
+GraphAsMatrix::EdgeIterator& GraphAsMatrix::end(int) {
     EdgeIterator *itr = new EdgeIterator(&edgesContainer[edgesContainer.size()]);
     return *itr;
 }
 
-void GraphAsMatrix::displayEdges() {
+//* scan of one matrix row (missing tiles are skipped); the weight is read only for existing edges
+template<typename Function>
+void GraphAsMatrix::for_each_out_neighbor(const int vertex, Function&& function) const {
+    if (vertex < 0 || vertex >= this->number_of_vertices) return;
+
+    adjacency_matrix.for_each_in_row(vertex, [&function](int v_incoming, const Edge *edge) {
+        function(v_incoming, edge->get_weight());
+    });
+}
+
+template<typename Function>
+void GraphAsMatrix::for_each_in_neighbor(const int vertex, Function&& function) const {
+    if (vertex < 0 || vertex >= this->number_of_vertices) return;
+
+    for (int v_outgoing : incoming[vertex]) {
+        function(v_outgoing, adjacency_matrix.get(v_outgoing, vertex)->get_weight());
+    }
+}
+
+void GraphAsMatrix::displayEdges(const DumpOptions& options) {
     Log::Info("Display graph");
+
+    BufferedWriter console(stdout);
     // Otwieramy plik do zapisu w trybie dopisywania.
-    std::ofstream file("Logi.txt", std::ios::app);
+    BufferedWriter file("Logi.txt", true);
 
-    if (!file) {
+    if (!file.is_open()) {
         // W przypadku błędu podczas otwierania pliku, wypisujemy komunikat.
         std::cout << "Błąd podczas otwierania pliku." << std::endl;
         return;
     }
 
-    for (std::vector<Edge*> edges: adjacency_matrix) {
-        std::cout << std::setw(33) << "";
-        file << std::setw(33) << "";
-        for (Edge *edge: edges) {
-            if(edge) {
-                std::cout<<"("<<(*edge).get_outgoing_vertex()->get_index()<<" - "<<(*edge).get_incoming_vertex()->get_index()<<")    ";
-                file <<"("<<(*edge).get_outgoing_vertex()->get_index()<<" - "<<(*edge).get_incoming_vertex()->get_index()<<")    ";
-            } else {
-                std::cout<<"(# - #)"<<"    ";
-                file <<"(# - #)"<<"    ";
-            }
-        }
-        std::cout<<'\n';
-        file <<'\n';
-    }
-    std::cout<<'\n';
-    file <<'\n';
-    file.close();
+    GraphDump dump(options);
+    dump.write(*this, console);
+    dump.write(*this, file);
+    console.put('\n');
+    file.put('\n');
 }
 
-void GraphAsMatrix::dfs(std::vector<std::vector<Edge*>>& adjacency_matrix_copy, int v,
-        std::vector<int>& path, std::vector<bool>& visited,
-        Edge* lastEdge, std::vector<std::vector<int>>& cycles) {
-    visited[v] = true;
-    path.push_back(v);
-
-    for (Edge* edge : adjacency_matrix_copy[v]) {
-        if (edge && edge != lastEdge) {
-            int mate = edge->get_mate(vertices_list[v])->get_index();
-
-            if (!visited[mate]) {
-                dfs(adjacency_matrix_copy, mate, path, visited, lastEdge, cycles);
-            } else {
-                std::vector<int>::iterator cycleStart = std::find(path.begin(), path.end(), mate);
-                if (cycleStart != path.end()) {
-                    std::vector<int> cycle(cycleStart, path.end());
-                    cycles.push_back(cycle);
-                    adjacency_matrix_copy[v][mate] = nullptr;
-                }
-            }
-        }
+bool GraphAsMatrix::dump(const std::string& filename, const DumpOptions& options) const {
+    BufferedWriter file(filename, false);
+
+    if (!file.is_open()) {
+        std::cout << "Błąd podczas otwierania pliku." << std::endl;
+        return false;
     }
 
-    path.pop_back();
-    visited[v] = false;
+    GraphDump(options).write(*this, file);
+    return true;
 }
-        
+
 void GraphAsMatrix::readData(const std::string& filename) {
-    std::ifstream file(filename);
+    std::FILE *file = std::fopen(filename.c_str(), "rb");
     if (!file) {
         std::cout << "Błąd podczas otwierania pliku." << std::endl;
         return;
     }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        int x, y = -1;
-        if (!(iss >> x >> y)) {
-            std::cout << "Błąd podczas odczytu danych." << std::endl;
-            break;
+    //* every line: v_outgoing v_incoming [weight]
+    EdgeListTokenizer tokenizer;
+    const int edges_before = this->number_of_edges;
+    const bool result = tokenizer.read(file, [this](const long long *fields, int count) {
+        if (count < 2) return false;
+        //* a value that does not fit in int stops reading, as the failed iss >> int did;
+        //* ids outside of the graph are skipped by insert_edge, as add_edge always did
+        for (int i = 0; i < count && i < 3; i++) {
+            if (fields[i] < INT_MIN || fields[i] > INT_MAX) return false;
         }
 
-        add_edge(x, y);
+        insert_edge(static_cast<int>(fields[0]), static_cast<int>(fields[1]), count > 2 ? static_cast<int>(fields[2]) : 0);
+        return true;
+    });
+
+    if (!result) {
+        std::cout << "Błąd podczas odczytu danych." << std::endl;
     }
+    Log::Info("Read " + std::to_string(this->number_of_edges - edges_before) + " edges from " + filename);
 
-    displayEdges();
+    DumpOptions preview;
+    preview.max_rows = DISPLAY_ROWS_LIMIT;
+    preview.indent = 33;
+    displayEdges(preview);
 
-    file.close();
+    std::fclose(file);
 }
 
 #endif
@@ -0,0 +1,138 @@
+#ifndef GRAPH_CONCEPT_H
+#define GRAPH_CONCEPT_H
+
+#include "Graph.h"
+#include <concepts>
+#include <functional>
+
+//* callback used only to spell the requirements of OutNeighborGraph
+struct NeighborSink {
+    void operator()(int, int) const {}
+};
+
+/**
+ * @brief Graph whose out-neighbours can be visited through a template member:
+ * @note     graph.for_each_out_neighbor(v, [](int v_incoming, int weight) { ... });
+ * @note Algorithms written over this concept are instantiated per backend, so the neighbour
+ * @note loop is inlined into them - no virtual call, no std::function and no Edge* to follow.
+ */
+template<typename G>
+concept OutNeighborGraph = requires(const G& graph, int vertex, NeighborSink sink) {
+    { graph.get_number_of_vertices() } -> std::convertible_to<int>;
+    { graph.get_number_of_edges() } -> std::convertible_to<int>;
+    graph.for_each_out_neighbor(vertex, sink);
+};
+
+/**
+ * @brief OutNeighborGraph that also visits in-neighbours, graph.for_each_in_neighbor(v, f) calls
+ * f(v_outgoing, weight) for every edge v_outgoing -> v, in time proportional to the in-degree.
+ */
+template<typename G>
+concept InNeighborGraph = OutNeighborGraph<G> && requires(const G& graph, int vertex, NeighborSink sink) {
+    graph.for_each_in_neighbor(vertex, sink);
+};
+
+/**
+ * @brief Calls graph.finalize(in_neighbors) when the backend has one. Parallel algorithms call it
+ * on the calling thread before the first concurrent read: GraphAsCSR and GraphAsHybrid merge
+ * pending edges and build the transpose inside const queries, which is not safe from many threads.
+ */
+template<typename G>
+void finalize_graph(const G& graph, bool in_neighbors = false) {
+    if constexpr (requires { graph.finalize(in_neighbors); }) graph.finalize(in_neighbors);
+}
+
+/**
+ * @brief CRTP base of the backends: Derived provides the template for_each_out_neighbor and
+ * for_each_in_neighbor and gets the virtual Graph::for_each_emanating/for_each_incident
+ * (and a few helpers) built on top of them.
+ */
+template<typename Derived>
+class StaticGraph : public Graph {
+    public:
+        StaticGraph(const int n) : Graph(n) {}
+
+        void for_each_emanating(const int vertex, const EdgeVisitor& visitor) const override {
+            derived().for_each_out_neighbor(vertex, visitor);
+        }
+
+        void for_each_incident(const int vertex, const EdgeVisitor& visitor) const override {
+            derived().for_each_in_neighbor(vertex, visitor);
+        }
+
+        //! wywołuje function(v_outgoing, v_incoming, weight) dla każdej krawędzi grafu
+        template<typename Function>
+        void for_each_edge(Function&& function) const {
+            for (int v = 0; v < this->number_of_vertices; v++) {
+                derived().for_each_out_neighbor(v, [&function, v](int v_incoming, int weight) {
+                    function(v, v_incoming, weight);
+                });
+            }
+        }
+
+        int count_out_neighbors(const int vertex) const {
+            int result = 0;
+            derived().for_each_out_neighbor(vertex, [&result](int, int) { result++;});
+            return result;
+        }
+
+    protected:
+        const Derived& derived() const { return static_cast<const Derived&>(*this);}
+};
+
+/**
+ * @brief Adapter that lets the template algorithms run on any Graph through the virtual
+ * for_each_emanating, e.g. for a backend known only as Graph&.
+ */
+class VirtualGraph {
+    public:
+        VirtualGraph(const Graph& graph) : graph(graph) {}
+
+        int get_number_of_vertices() const { return graph.get_number_of_vertices();}
+        int get_number_of_edges() const { return graph.get_number_of_edges();}
+
+        template<typename Function>
+        void for_each_out_neighbor(const int vertex, Function&& function) const {
+            graph.for_each_emanating(vertex, std::ref(function));
+        }
+
+        template<typename Function>
+        void for_each_in_neighbor(const int vertex, Function&& function) const {
+            graph.for_each_incident(vertex, std::ref(function));
+        }
+
+        void finalize(bool in_neighbors = false) const { graph.finalize(in_neighbors);}
+
+    private:
+        const Graph& graph;
+};
+
+/**
+ * @brief The graph with every edge reversed, without a copy: out-neighbours of the view are
+ * in-neighbours of the base, e.g. bfs_distances(ReverseGraph(graph), t) gives distances to t.
+ */
+template<InNeighborGraph G>
+class ReverseGraph {
+    public:
+        ReverseGraph(const G& base) : base(base) {}
+
+        int get_number_of_vertices() const { return base.get_number_of_vertices();}
+        int get_number_of_edges() const { return base.get_number_of_edges();}
+
+        template<typename Function>
+        void for_each_out_neighbor(const int vertex, Function&& function) const {
+            base.for_each_in_neighbor(vertex, function);
+        }
+
+        template<typename Function>
+        void for_each_in_neighbor(const int vertex, Function&& function) const {
+            base.for_each_out_neighbor(vertex, function);
+        }
+
+        //* out-neighbours of the view are in-neighbours of the base
+        void finalize(bool = false) const { finalize_graph(base, true);}
+
+    private:
+        const G& base;
+};
+#endif
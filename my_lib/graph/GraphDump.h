@@ -0,0 +1,138 @@
+#ifndef GRAPH_DUMP_H
+#define GRAPH_DUMP_H
+
+#include "Graph.h"
+#include "BufferedWriter.h"
+#include "DotFormat.h"
+#include "VertexIdMap.h"
+#include <utility>
+#include <vector>
+
+enum class DumpFormat {
+    EDGE_LIST,      //* "0	2" - one edge per line, the same layout as res/*.csv
+    ADJACENCY_LIST, //* "0: 2 3" - one source vertex per line
+    DOT             //* digraph { 0 -> 2 } - written by DotWriter, the same layout as graph.dot
+};
+
+struct DumpOptions {
+    DumpFormat format = DumpFormat::EDGE_LIST;
+    int max_rows = 0;       //* maximum number of source vertices written, 0 means no limit
+    int sample_every = 1;   //* write only every n-th source vertex that has edges
+    bool weights = false;   //* append the edge weight to every written edge
+    int indent = 0;         //* number of spaces in front of every line
+    const VertexIdMap *ids = nullptr; //* write original ids instead of dense ones (EdgeList::ids)
+};
+
+/**
+ * @brief Streams the edges of any Graph in one of DumpFormat layouts.
+ * @note Only existing edges are visited (Graph::for_each_emanating), so the amount
+ * @note of written text is O(m) instead of O(n^2) cells of the adjacency matrix.
+ */
+class GraphDump {
+    public:
+        GraphDump(const DumpOptions& options = DumpOptions()) : options(options) {}
+
+        /**
+         * @brief Writes the graph to out and returns the number of written edges; *truncated
+         * tells whether max_rows cut the dump short.
+         * @note Only ADJACENCY_LIST and DOT get a "// ... limit" line, an EDGE_LIST dump stays
+         * @note readable by EdgeListTokenizer.
+         */
+        size_t write(const Graph& graph, BufferedWriter& out, bool *truncated = nullptr) const;
+
+    private:
+        DumpOptions options;
+
+        DotWriter dot_writer() const;
+        void write_edge(BufferedWriter& out, int v_outgoing, int v_incoming, int weight) const;
+        void write_vertex(BufferedWriter& out, int v) const {
+            if (options.ids) out.write_uint(options.ids->original(v));
+            else out.write_int(v);
+        }
+};
+
+size_t GraphDump::write(const Graph& graph, BufferedWriter& out, bool *truncated) const {
+    const int sample_every = options.sample_every > 0 ? options.sample_every : 1;
+    std::vector<std::pair<int, int>> row; // (v_incoming, weight) of the current source vertex
+    size_t written_edges = 0;
+    int written_rows = 0;
+    int candidate_rows = 0;
+    bool limited = false;
+
+    const DotWriter dot = dot_writer();
+    if (options.format == DumpFormat::DOT) dot.write_header(out, graph.get_number_of_vertices());
+
+    for (int v = 0; v < graph.get_number_of_vertices(); v++) {
+        row.clear();
+        graph.for_each_emanating(v, [&row](int v_incoming, int weight) {
+            row.emplace_back(v_incoming, weight);
+        });
+        if (row.empty()) continue;
+        if (candidate_rows++ % sample_every != 0) continue;
+
+        if (options.max_rows > 0 && written_rows == options.max_rows) {
+            limited = true;
+            break;
+        }
+        written_rows++;
+
+        if (options.format == DumpFormat::ADJACENCY_LIST) {
+            out.pad(options.indent);
+            write_vertex(out, v);
+            out.put(':');
+            for (const std::pair<int, int>& edge : row) {
+                out.put(' ');
+                write_vertex(out, edge.first);
+                if (options.weights) {
+                    out.put('/');
+                    out.write_int(edge.second);
+                }
+            }
+            out.put('\n');
+        } else if (options.format == DumpFormat::DOT) {
+            for (const std::pair<int, int>& edge : row) {
+                dot.write_edge(out, v, edge.first, edge.second);
+            }
+        } else {
+            for (const std::pair<int, int>& edge : row) {
+                write_edge(out, v, edge.first, edge.second);
+            }
+        }
+        written_edges += row.size();
+    }
+
+    if (truncated) *truncated = limited;
+    if (limited && options.format != DumpFormat::EDGE_LIST) {
+        out.pad(options.indent);
+        if (options.format == DumpFormat::DOT) out.write("    ");
+        out.write("// ... limit of ");
+        out.write_int(options.max_rows);
+        out.write(" rows reached\n");
+    }
+
+    if (options.format == DumpFormat::DOT) dot.write_footer(out);
+
+    return written_edges;
+}
+
+DotWriter GraphDump::dot_writer() const {
+    DotWriterOptions dot_options;
+    dot_options.weights = options.weights;
+    dot_options.ids = options.ids;
+    dot_options.indent = options.indent;
+    return DotWriter(dot_options);
+}
+
+//* one line of an EDGE_LIST dump
+void GraphDump::write_edge(BufferedWriter& out, int v_outgoing, int v_incoming, int weight) const {
+    out.pad(options.indent);
+    write_vertex(out, v_outgoing);
+    out.put('\t');
+    write_vertex(out, v_incoming);
+    if (options.weights) {
+        out.put('\t');
+        out.write_int(weight);
+    }
+    out.put('\n');
+}
+#endif
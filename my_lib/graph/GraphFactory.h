@@ -0,0 +1,188 @@
+#ifndef GRAPH_FACTORY_H
+#define GRAPH_FACTORY_H
+
+#include "Graph.h"
+#include "GraphAsMatrix.h"
+#include "GraphAsCSR.h"
+#include "GraphAsHybrid.h"
+#include "EdgeList.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class GraphBackend {
+    AUTO,       //* let choose_backend decide
+    MATRIX,     //* GraphAsMatrix - Edge* in tiles, cheap add_edge, for small graphs
+    BITSET,     //* GraphAsHybrid with every non-empty row as a bitset - dense graphs
+    CSR,        //* GraphAsCSR (UnweightedGraphAsCSR without weights) - sparse graphs
+    HYBRID      //* GraphAsHybrid - bitset rows for hubs, sorted arrays elsewhere
+};
+
+const char* backend_name(GraphBackend backend) {
+    switch (backend) {
+        case GraphBackend::AUTO:   return "AUTO";
+        case GraphBackend::MATRIX: return "MATRIX";
+        case GraphBackend::BITSET: return "BITSET";
+        case GraphBackend::CSR:    return "CSR";
+        case GraphBackend::HYBRID: return "HYBRID";
+    }
+    return "?";
+}
+
+/**
+ * @brief Shape of an edge list measured before any backend is built, O(n + m).
+ * @note Degrees count every valid line of the list, so duplicated edges make them (and the
+ * @note memory estimates) slightly too high.
+ */
+struct GraphProfile {
+    int number_of_vertices = 0;
+    long long number_of_edges = 0;
+    bool weighted = false;       //* some weight is not 0
+    int max_degree = 0;
+    int non_empty_rows = 0;
+    int dense_rows = 0;          //* rows a HYBRID graph would keep as bitsets
+    size_t hub_row_bytes = 0;    //* bitset bytes of those rows
+    size_t sparse_row_bytes = 0; //* array bytes of the other rows
+
+    double density() const {
+        const double n = number_of_vertices;
+        return n > 0 ? static_cast<double>(number_of_edges) / (n * n) : 0.0;
+    }
+    double average_degree() const {
+        return number_of_vertices > 0 ? static_cast<double>(number_of_edges) / number_of_vertices : 0.0;
+    }
+
+    //! szacowana liczba bajtów tablic sąsiedztwa danego backendu
+    size_t estimated_bytes(GraphBackend backend) const;
+};
+
+size_t GraphProfile::estimated_bytes(GraphBackend backend) const {
+    const size_t n = number_of_vertices;
+    const size_t m = number_of_edges;
+    const size_t words = (n + 63) / 64;
+    const size_t row_bytes = words * sizeof(uint64_t) + (words + GraphAsHybrid::RANK_BLOCK - 1) / GraphAsHybrid::RANK_BLOCK * sizeof(uint32_t);
+    const size_t weight_bytes = weighted ? m * sizeof(int) : 0;
+    const size_t hybrid_offsets = 3 * n * sizeof(int);
+
+    switch (backend) {
+        case GraphBackend::MATRIX: {
+            //* upper bound: every tile holding an edge allocated, plus the Edge objects
+            const size_t tiles = (n + TiledMatrix<Edge*>::TILE - 1) / TiledMatrix<Edge*>::TILE;
+            const size_t allocated = std::min(tiles * tiles, m);
+            return allocated * TiledMatrix<Edge*>::TILE_CELLS * sizeof(Edge*) + m * sizeof(Edge);
+        }
+        case GraphBackend::BITSET:
+            return non_empty_rows * row_bytes + hybrid_offsets + weight_bytes;
+        case GraphBackend::CSR:
+            return (n + 1) * sizeof(int) + m * (weighted ? sizeof(CompactEdge<int>) : sizeof(CompactEdge<NoWeight>));
+        case GraphBackend::HYBRID:
+            return hub_row_bytes + sparse_row_bytes + hybrid_offsets + weight_bytes;
+        case GraphBackend::AUTO:
+            break;
+    }
+    return 0;
+}
+
+GraphProfile profile_graph(const EdgeList& list) {
+    GraphProfile profile;
+    const int n = list.number_of_vertices;
+    profile.number_of_vertices = n;
+
+    std::vector<int> degree(n, 0);
+    for (const EdgeRecord& edge : list.edges) {
+        if (edge.v_outgoing < 0 || edge.v_outgoing >= n || edge.v_incoming < 0 || edge.v_incoming >= n) continue;
+        degree[edge.v_outgoing]++;
+        profile.number_of_edges++;
+        if (edge.weight != 0) profile.weighted = true;
+    }
+
+    const int dense_degree = GraphAsHybrid::default_dense_degree(n);
+    const size_t words = (static_cast<size_t>(n) + 63) / 64;
+    const size_t row_bytes = words * sizeof(uint64_t) + (words + GraphAsHybrid::RANK_BLOCK - 1) / GraphAsHybrid::RANK_BLOCK * sizeof(uint32_t);
+    for (int d : degree) {
+        if (d > profile.max_degree) profile.max_degree = d;
+        if (d > 0) profile.non_empty_rows++;
+        if (d >= dense_degree) {
+            profile.dense_rows++;
+            profile.hub_row_bytes += row_bytes;
+        } else {
+            profile.sparse_row_bytes += static_cast<size_t>(d) * sizeof(int);
+        }
+    }
+    return profile;
+}
+
+constexpr int MATRIX_VERTICES_LIMIT = 1024; //* up to this size the cells of GraphAsMatrix take at most 8 MB
+constexpr long long MATRIX_EDGES_LIMIT = 8 * MATRIX_VERTICES_LIMIT; //* and a new Edge per edge stays cheap
+constexpr double HUB_MEMORY_SLACK = 1.25;   //* bitset rows may cost this much more than CSR, is_edge on them is one bit test
+
+/**
+ * @brief Small graphs (few vertices and few edges) go to GraphAsMatrix. Otherwise, a small but
+ * dense graph included, the rows a bitset stores more compactly than an array decide: without
+ * them CSR; with them BITSET (all non-empty rows) or HYBRID (hubs of a skewed degree
+ * distribution), unless their per-vertex arrays make the layout more than HUB_MEMORY_SLACK
+ * times larger than CSR.
+ */
+GraphBackend choose_backend(const GraphProfile& profile) {
+    if (profile.number_of_vertices <= MATRIX_VERTICES_LIMIT && profile.number_of_edges <= MATRIX_EDGES_LIMIT) {
+        return GraphBackend::MATRIX;
+    }
+    if (profile.dense_rows == 0) return GraphBackend::CSR;
+
+    const GraphBackend dense = (profile.dense_rows == profile.non_empty_rows) ? GraphBackend::BITSET : GraphBackend::HYBRID;
+    const double csr_bytes = static_cast<double>(profile.estimated_bytes(GraphBackend::CSR));
+    return (profile.estimated_bytes(dense) <= HUB_MEMORY_SLACK * csr_bytes) ? dense : GraphBackend::CSR;
+}
+
+/**
+ * @brief Which backend was built and why, see describe().
+ */
+struct GraphChoice {
+    GraphBackend backend = GraphBackend::AUTO;
+    bool overridden = false;    //* backend was given by the caller, not chosen
+    GraphProfile profile;
+
+    std::string describe() const;
+};
+
+std::string GraphChoice::describe() const {
+    char buffer[512];
+    std::snprintf(buffer, sizeof(buffer),
+            "%s (%s): n = %d, m = %lld, density = %.6f, average degree = %.2f, max degree = %d, "
+            "hub rows = %d; estimated bytes: MATRIX <= %zu, BITSET %zu, CSR %zu, HYBRID %zu",
+            backend_name(backend), overridden ? "override" : "auto",
+            profile.number_of_vertices, profile.number_of_edges, profile.density(), profile.average_degree(),
+            profile.max_degree, profile.dense_rows,
+            profile.estimated_bytes(GraphBackend::MATRIX), profile.estimated_bytes(GraphBackend::BITSET),
+            profile.estimated_bytes(GraphBackend::CSR), profile.estimated_bytes(GraphBackend::HYBRID));
+    return buffer;
+}
+
+/**
+ * @brief Builds the graph of an edge list in the backend chosen for its shape
+ * (or in the given one) and optionally reports the decision.
+ */
+std::unique_ptr<Graph> make_graph(const EdgeList& list, GraphBackend backend = GraphBackend::AUTO, GraphChoice *choice = nullptr) {
+    GraphChoice decision;
+    decision.profile = profile_graph(list);
+    decision.overridden = backend != GraphBackend::AUTO;
+    decision.backend = decision.overridden ? backend : choose_backend(decision.profile);
+    if (choice) *choice = decision;
+
+    switch (decision.backend) {
+        case GraphBackend::MATRIX:
+            return std::unique_ptr<Graph>(new GraphAsMatrix(list));
+        case GraphBackend::BITSET:
+            return std::unique_ptr<Graph>(new GraphAsHybrid(list, 1));
+        case GraphBackend::HYBRID:
+            return std::unique_ptr<Graph>(new GraphAsHybrid(list));
+        case GraphBackend::CSR:
+        case GraphBackend::AUTO:
+            break;
+    }
+    if (decision.profile.weighted) return std::unique_ptr<Graph>(new GraphAsCSR(list));
+    return std::unique_ptr<Graph>(new UnweightedGraphAsCSR(list));
+}
+#endif
@@ -0,0 +1,34 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "ThreadPool.h"
+
+//! rozmiar globalnej puli wątków (ThreadPool::configure), domyślnie liczba wątków sprzętowych
+int default_thread_count() {
+    return ThreadPool::get_configured_size();
+}
+
+/**
+ * @brief Calls function(i) for every i in [begin, end) on up to threads threads (the calling
+ * one included) and returns when all calls have finished.
+ * @note The calls run as tasks of the global ThreadPool, which splits the range adaptively,
+ * @note so items of uneven cost balance themselves; an item should still be a sizeable piece
+ * @note of work (a block, a row of blocks), not a single cell.
+ */
+template<typename Function>
+void parallel_for(const int begin, const int end, Function&& function, int threads = default_thread_count()) {
+    if (end - begin < threads) threads = end - begin;
+    if (threads <= 1) {
+        for (int i = begin; i < end; i++) function(i);
+        return;
+    }
+    TaskGroup group;
+    group.get_pool().parallel_for(group, begin, end, function, threads);
+}
+
+//! jak wyżej, w podanej grupie: group.cancel() (np. z wnętrza function) wstrzymuje kolejne wywołania
+template<typename Function>
+void parallel_for(TaskGroup& group, const int begin, const int end, Function&& function, int threads = default_thread_count()) {
+    group.get_pool().parallel_for(group, begin, end, function, std::max(1, threads));
+}
+#endif
@@ -0,0 +1,455 @@
+#ifndef PARTITIONING_H
+#define PARTITIONING_H
+
+#include "Graph.h"
+#include "GraphConcept.h"
+#include "Reordering.h"
+#include <algorithm>
+#include <climits>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <tuple>
+#include <vector>
+
+/**
+ * @brief k balanced parts of a graph: part[v], and a numbering that keeps every part in one
+ * range of ids (relabeling), ready for apply_relabeling or to hand ranges to threads/shards.
+ */
+struct Partition {
+    int parts = 0;
+    std::vector<int> part;              //* part[v] - part of vertex v
+    std::vector<int> part_offsets;      //* new ids of part p: [part_offsets[p], part_offsets[p + 1])
+    Relabeling relabeling;              //* new_id[v] - vertices of a part numbered consecutively
+    long long cut = 0;                  //* edges between different parts, both directions counted
+
+    int get_size(int p) const { return part_offsets[p + 1] - part_offsets[p];}
+    //! wywołuje function(v) dla każdego wierzchołka części p (stare numery)
+    template<typename Function>
+    void for_each_vertex(int p, Function&& function) const {
+        for (int i = part_offsets[p]; i < part_offsets[p + 1]; i++) function(relabeling.old_id[i]);
+    }
+    //! stosunek największej części do średniej, 1.0 - idealnie równe części
+    double imbalance() const;
+};
+
+double Partition::imbalance() const {
+    if (parts == 0 || part.empty()) return 1.0;
+    int largest = 0;
+    for (int p = 0; p < parts; p++) largest = std::max(largest, get_size(p));
+    return static_cast<double>(largest) * parts / static_cast<double>(part.size());
+}
+
+/**
+ * @brief Multilevel k-way partitioning (the METIS scheme) of the graph without directions.
+ * @note Coarsening: heavy-edge matching in random order merges every vertex with the unmatched
+ * @note neighbour joined by the heaviest edge, until the graph has about COARSEST_PER_PART * k
+ * @note vertices or stops shrinking. Vertex weights add up, parallel edges merge into weights.
+ * @note Initial partition: greedy graph growing on the coarsest graph - parts grow one after
+ * @note another from a random seed, always taking the vertex most connected to the part;
+ * @note the best of INITIAL_TRIES attempts is kept.
+ * @note Uncoarsening: the partition is projected back level by level and refined with k-way
+ * @note Fiduccia-Mattheyses passes - vertices move to the adjacent part with the best gain, also
+ * @note when it is negative, every vertex at most once per pass, and the pass is rolled back
+ * @note to the prefix with the smallest cut.
+ * @note A part may weigh at most (1 + epsilon) * n / k (plus one coarse vertex when that cannot
+ * @note be met exactly on the coarsest graph).
+ */
+class MultilevelPartitioner {
+    public:
+        MultilevelPartitioner(int parts, double epsilon = 0.03, unsigned seed = 1)
+            : parts(std::max(1, parts)), epsilon(epsilon), seed(seed) {}
+
+        template<OutNeighborGraph G>
+        Partition partition(const G& graph);
+        Partition partition(const Graph& graph) { return partition(VirtualGraph(graph));}
+
+    private:
+        static constexpr int COARSEST_PER_PART = 32;
+        static constexpr int INITIAL_TRIES = 4;
+        static constexpr int FM_PASSES = 4;
+
+        //* undirected weighted graph of one level, in CSR form
+        struct Level {
+            std::vector<int> offsets;
+            std::vector<int> targets;
+            std::vector<int> edge_weight;
+            std::vector<int> vertex_weight;
+            std::vector<int> coarse;    // numer wierzchołka na następnym (grubszym) poziomie
+
+            int size() const { return static_cast<int>(vertex_weight.size());}
+        };
+
+        int parts;
+        double epsilon;
+        unsigned seed;
+        std::mt19937 random;
+        long long max_part_weight = 0;
+        //* buffers of the gain computation
+        std::vector<long long> connection;
+        std::vector<int> touched_parts;
+
+        bool coarsen(Level& fine, Level& coarse);
+        void initial_partition(const Level& level, std::vector<int>& part);
+        long long grow(const Level& level, std::vector<int>& part);
+        void refine(const Level& level, std::vector<int>& part);
+        std::pair<long long, int> best_move(const Level& level, const std::vector<int>& part,
+                const std::vector<long long>& part_weight, int v);
+        static long long cut_of(const Level& level, const std::vector<int>& part);
+};
+
+template<OutNeighborGraph G>
+Partition MultilevelPartitioner::partition(const G& graph) {
+    random.seed(seed);
+    const int n = graph.get_number_of_vertices();
+
+    //* the finest level: out + in neighbours, parallel edges and both directions merged
+    std::vector<Level> levels(1);
+    {
+        Level& finest = levels[0];
+        finest.offsets.assign(n + 1, 0);
+        for (int v = 0; v < n; v++) {
+            graph.for_each_out_neighbor(v, [&](int v_incoming, int) {
+                if (v_incoming == v) return;
+                finest.offsets[v + 1]++;
+                finest.offsets[v_incoming + 1]++;
+            });
+        }
+        for (int v = 0; v < n; v++) finest.offsets[v + 1] += finest.offsets[v];
+        std::vector<int> raw(finest.offsets[n]);
+        std::vector<int> next(finest.offsets.begin(), finest.offsets.end() - 1);
+        for (int v = 0; v < n; v++) {
+            graph.for_each_out_neighbor(v, [&](int v_incoming, int) {
+                if (v_incoming == v) return;
+                raw[next[v]++] = v_incoming;
+                raw[next[v_incoming]++] = v;
+            });
+        }
+        finest.vertex_weight.assign(n, 1);
+        int written = 0;
+        for (int v = 0; v < n; v++) {
+            const int begin = finest.offsets[v];
+            std::sort(raw.begin() + begin, raw.begin() + finest.offsets[v + 1]);
+            finest.offsets[v] = written;
+            for (int i = begin; i < finest.offsets[v + 1]; i++) {
+                if (i > begin && raw[i] == raw[i - 1]) {
+                    finest.edge_weight.back()++;
+                    continue;
+                }
+                finest.targets.push_back(raw[i]);
+                finest.edge_weight.push_back(1);
+                written++;
+            }
+        }
+        finest.offsets[n] = written;
+    }
+
+    max_part_weight = static_cast<long long>((1.0 + epsilon) * n / parts) + 1;
+    connection.assign(parts, 0);
+
+    while (levels.back().size() > COARSEST_PER_PART * parts) {
+        Level coarse;
+        if (!coarsen(levels.back(), coarse)) break;
+        levels.push_back(std::move(coarse));
+    }
+
+    std::vector<int> part;
+    initial_partition(levels.back(), part);
+    for (int l = static_cast<int>(levels.size()) - 2; l >= 0; l--) {
+        std::vector<int> finer(levels[l].size());
+        for (int v = 0; v < levels[l].size(); v++) finer[v] = part[levels[l].coarse[v]];
+        part.swap(finer);
+        refine(levels[l], part);
+    }
+
+    Partition result;
+    result.parts = parts;
+    result.cut = cut_of(levels[0], part);
+    result.part = std::move(part);
+    result.part_offsets.assign(parts + 1, 0);
+    for (int v = 0; v < n; v++) result.part_offsets[result.part[v] + 1]++;
+    for (int p = 0; p < parts; p++) result.part_offsets[p + 1] += result.part_offsets[p];
+    result.relabeling.new_id.assign(n, 0);
+    result.relabeling.old_id.assign(n, 0);
+    std::vector<int> next(result.part_offsets.begin(), result.part_offsets.end() - 1);
+    for (int v = 0; v < n; v++) {
+        const int id = next[result.part[v]]++;
+        result.relabeling.new_id[v] = id;
+        result.relabeling.old_id[id] = v;
+    }
+    return result;
+}
+
+/**
+ * @brief One round of heavy-edge matching; false when it would shrink the graph by less than 10%.
+ */
+bool MultilevelPartitioner::coarsen(Level& fine, Level& coarse) {
+    const int n = fine.size();
+    const long long total = std::accumulate(fine.vertex_weight.begin(), fine.vertex_weight.end(), 0LL);
+    //* no coarse vertex heavier than a small piece of a part, so that parts can still be balanced
+    const long long heaviest = std::max(1LL, total / (static_cast<long long>(COARSEST_PER_PART) * parts / 2 + 1));
+
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), random);
+
+    std::vector<int> mate(n, -1);
+    for (int u : order) {
+        if (mate[u] != -1) continue;
+        int best = -1, best_weight = 0;
+        for (int i = fine.offsets[u]; i < fine.offsets[u + 1]; i++) {
+            const int v = fine.targets[i];
+            if (mate[v] != -1 || fine.vertex_weight[u] + fine.vertex_weight[v] > heaviest) continue;
+            if (fine.edge_weight[i] > best_weight ||
+                    (fine.edge_weight[i] == best_weight && fine.vertex_weight[v] < fine.vertex_weight[best])) {
+                best = v;
+                best_weight = fine.edge_weight[i];
+            }
+        }
+        mate[u] = (best == -1) ? u : best;
+        if (best != -1) mate[best] = u;
+    }
+
+    fine.coarse.assign(n, -1);
+    int count = 0;
+    for (int u = 0; u < n; u++) {
+        if (fine.coarse[u] != -1) continue;
+        fine.coarse[u] = fine.coarse[mate[u]] = count++;
+    }
+    if (count > n - n / 10) {
+        fine.coarse.clear();
+        return false;
+    }
+
+    //* edges of the two merged vertices, summed per coarse neighbour through a slot array
+    coarse.offsets.assign(count + 1, 0);
+    coarse.vertex_weight.assign(count, 0);
+    coarse.targets.clear();
+    coarse.edge_weight.clear();
+    std::vector<int> slot(count, -1);
+    int c = 0;
+    for (int u = 0; u < n; u++) {
+        if (fine.coarse[u] != c) continue;  // para zostaje obsłużona przy mniejszym wierzchołku
+        const int row = static_cast<int>(coarse.targets.size());
+        for (int member : {u, mate[u]}) {
+            coarse.vertex_weight[c] += fine.vertex_weight[member];
+            for (int i = fine.offsets[member]; i < fine.offsets[member + 1]; i++) {
+                const int target = fine.coarse[fine.targets[i]];
+                if (target == c) continue;
+                if (slot[target] >= row) {
+                    coarse.edge_weight[slot[target]] += fine.edge_weight[i];
+                } else {
+                    slot[target] = static_cast<int>(coarse.targets.size());
+                    coarse.targets.push_back(target);
+                    coarse.edge_weight.push_back(fine.edge_weight[i]);
+                }
+            }
+            if (mate[u] == u) break;
+        }
+        coarse.offsets[++c] = static_cast<int>(coarse.targets.size());
+    }
+    return true;
+}
+
+long long MultilevelPartitioner::cut_of(const Level& level, const std::vector<int>& part) {
+    long long cut = 0;
+    for (int v = 0; v < level.size(); v++) {
+        for (int i = level.offsets[v]; i < level.offsets[v + 1]; i++) {
+            if (part[level.targets[i]] != part[v]) cut += level.edge_weight[i];
+        }
+    }
+    return cut / 2;
+}
+
+/**
+ * @brief Greedy graph growing: part p takes the unassigned vertex most connected to it until
+ * it holds its share of the remaining weight; the last part takes the rest. Returns the cut.
+ */
+long long MultilevelPartitioner::grow(const Level& level, std::vector<int>& part) {
+    const int n = level.size();
+    part.assign(n, -1);
+    std::vector<int> unassigned(n);
+    std::iota(unassigned.begin(), unassigned.end(), 0);
+    std::shuffle(unassigned.begin(), unassigned.end(), random);
+    size_t next_seed = 0;
+
+    long long remaining = std::accumulate(level.vertex_weight.begin(), level.vertex_weight.end(), 0LL);
+    std::vector<long long> gain(n, 0);
+    std::priority_queue<std::pair<long long, int>> queue;
+    for (int p = 0; p + 1 < parts; p++) {
+        const long long target = remaining / (parts - p);
+        long long weight = 0;
+        std::vector<int> reached;
+        while (weight < target) {
+            if (queue.empty()) {
+                while (next_seed < unassigned.size() && part[unassigned[next_seed]] != -1) next_seed++;
+                if (next_seed == unassigned.size()) break;
+                const int seed_vertex = unassigned[next_seed++];
+                queue.push({gain[seed_vertex], seed_vertex});
+            }
+            const auto [g, v] = queue.top();
+            queue.pop();
+            if (part[v] != -1 || g != gain[v]) continue;
+            if (weight > 0 && weight + level.vertex_weight[v] > max_part_weight) continue;
+            part[v] = p;
+            weight += level.vertex_weight[v];
+            for (int i = level.offsets[v]; i < level.offsets[v + 1]; i++) {
+                const int u = level.targets[i];
+                if (part[u] != -1) continue;
+                if (gain[u] == 0) reached.push_back(u);
+                gain[u] += level.edge_weight[i];
+                queue.push({gain[u], u});
+            }
+        }
+        remaining -= weight;
+        for (int u : reached) gain[u] = 0;
+        queue = std::priority_queue<std::pair<long long, int>>();
+    }
+    for (int v = 0; v < n; v++) {
+        if (part[v] == -1) part[v] = parts - 1;
+    }
+    refine(level, part);
+    return cut_of(level, part);
+}
+
+void MultilevelPartitioner::initial_partition(const Level& level, std::vector<int>& part) {
+    long long best_cut = LLONG_MAX;
+    std::vector<int> attempt;
+    for (int t = 0; t < INITIAL_TRIES; t++) {
+        const long long cut = grow(level, attempt);
+        if (cut < best_cut) {
+            best_cut = cut;
+            part = attempt;
+        }
+    }
+}
+
+/**
+ * @brief The best move of v: (gain, part), part -1 when v has no neighbour in another part or
+ * no such part can take it. Moves out of an overweight part are allowed whatever the gain.
+ */
+std::pair<long long, int> MultilevelPartitioner::best_move(const Level& level, const std::vector<int>& part,
+        const std::vector<long long>& part_weight, int v) {
+    const int from = part[v];
+    for (int i = level.offsets[v]; i < level.offsets[v + 1]; i++) {
+        const int p = part[level.targets[i]];
+        if (connection[p] == 0) touched_parts.push_back(p);
+        connection[p] += level.edge_weight[i];
+    }
+
+    const long long internal = connection[from];
+    long long best_gain = LLONG_MIN;
+    int best = -1;
+    for (int p : touched_parts) {
+        if (p == from || part_weight[p] + level.vertex_weight[v] > max_part_weight) continue;
+        const long long gain = connection[p] - internal;
+        if (gain > best_gain || (gain == best_gain && part_weight[p] < part_weight[best])) {
+            best_gain = gain;
+            best = p;
+        }
+    }
+    for (int p : touched_parts) connection[p] = 0;
+    touched_parts.clear();
+
+    if (best == -1 && part_weight[from] > max_part_weight) {
+        //* przeciążona część oddaje wierzchołek najlżejszej
+        best = static_cast<int>(std::min_element(part_weight.begin(), part_weight.end()) - part_weight.begin());
+        if (best == from) return {0, -1};
+        long long to_best = 0;
+        for (int i = level.offsets[v]; i < level.offsets[v + 1]; i++) {
+            if (part[level.targets[i]] == best) to_best += level.edge_weight[i];
+        }
+        best_gain = to_best - internal;
+    }
+    return {best_gain, best};
+}
+
+void MultilevelPartitioner::refine(const Level& level, std::vector<int>& part) {
+    const int n = level.size();
+    std::vector<long long> part_weight(parts, 0);
+    for (int v = 0; v < n; v++) part_weight[part[v]] += level.vertex_weight[v];
+    std::vector<uint8_t> locked(n);
+    std::vector<std::pair<int, int>> moves;   // wierzchołek, część przed ruchem
+    const int patience = std::max(64, n / 100);
+
+    for (int pass = 0; pass < FM_PASSES; pass++) {
+        std::fill(locked.begin(), locked.end(), 0);
+        moves.clear();
+        //* gain, vertex, target part
+        std::priority_queue<std::tuple<long long, int, int>> queue;
+        auto overweight = [&]() {
+            for (long long w : part_weight) if (w > max_part_weight) return true;
+            return false;
+        };
+        const bool balancing = overweight();
+        for (int v = 0; v < n; v++) {
+            bool boundary = balancing;
+            for (int i = level.offsets[v]; i < level.offsets[v + 1] && !boundary; i++) boundary = part[level.targets[i]] != part[v];
+            if (!boundary) continue;
+            const auto [gain, to] = best_move(level, part, part_weight, v);
+            if (to != -1) queue.push({gain, v, to});
+        }
+
+        long long total = 0, best_total = 0;
+        size_t best_length = 0;
+        bool best_balanced = !balancing;
+        int since_best = 0;
+        while (!queue.empty() && since_best < patience) {
+            const auto [gain, v, to] = queue.top();
+            queue.pop();
+            if (locked[v]) continue;
+            const auto [current_gain, current_to] = best_move(level, part, part_weight, v);
+            if (current_to == -1) continue;
+            if (current_gain != gain || current_to != to) {
+                queue.push({current_gain, v, current_to});
+                continue;
+            }
+
+            const int from = part[v];
+            part[v] = to;
+            part_weight[from] -= level.vertex_weight[v];
+            part_weight[to] += level.vertex_weight[v];
+            locked[v] = 1;
+            moves.push_back({v, from});
+            total += gain;
+
+            const bool balanced = !overweight();
+            if ((balanced && !best_balanced) || (balanced == best_balanced && total > best_total)) {
+                best_total = total;
+                best_length = moves.size();
+                best_balanced = balanced;
+                since_best = 0;
+            } else {
+                since_best++;
+            }
+
+            for (int i = level.offsets[v]; i < level.offsets[v + 1]; i++) {
+                const int u = level.targets[i];
+                if (locked[u]) continue;
+                const auto [u_gain, u_to] = best_move(level, part, part_weight, u);
+                if (u_to != -1) queue.push({u_gain, u, u_to});
+            }
+        }
+
+        //* back to the best prefix of the pass
+        while (moves.size() > best_length) {
+            const auto [v, from] = moves.back();
+            moves.pop_back();
+            part_weight[part[v]] -= level.vertex_weight[v];
+            part_weight[from] += level.vertex_weight[v];
+            part[v] = from;
+        }
+        if (best_total <= 0 && !(balancing && best_balanced)) break;
+    }
+}
+
+//! podział grafu na parts zrównoważonych części z małym przekrojem, patrz MultilevelPartitioner
+template<OutNeighborGraph G>
+Partition partition_graph(const G& graph, int parts, double epsilon = 0.03) {
+    return MultilevelPartitioner(parts, epsilon).partition(graph);
+}
+
+Partition partition_graph(const Graph& graph, int parts, double epsilon = 0.03) {
+    return partition_graph(VirtualGraph(graph), parts, epsilon);
+}
+#endif
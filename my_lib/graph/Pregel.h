@@ -0,0 +1,363 @@
+#ifndef PREGEL_H
+#define PREGEL_H
+
+#include "Graph.h"
+#include "GraphConcept.h"
+#include "DynamicBitset.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+//* messages delivered to one vertex in one superstep
+template<typename Message>
+struct MessageRange {
+    const Message *first = nullptr;
+    const Message *last = nullptr;
+
+    const Message* begin() const { return first;}
+    const Message* end() const { return last;}
+    int size() const { return static_cast<int>(last - first);}
+    bool empty() const { return first == last;}
+};
+
+/**
+ * @brief Vertex-centric bulk synchronous engine (Pregel). Program supplies
+ * @note     using Value = ...; using Message = ...;
+ * @note     void compute(PregelEngine<Program, G>::Context& vertex, MessageRange<Message> messages);
+ * @note and optionally static Message combine(Message a, Message b) - a commutative,
+ * @note associative combiner, with which every vertex gets at most one message per superstep.
+ * @note In superstep 0 every vertex is active and gets no messages. A vertex that calls
+ * @note vote_to_halt() sleeps until a message arrives; the run ends when all vertices sleep
+ * @note and no message is in flight, or after max_supersteps.
+ * @note Vertices are split into partitions - ranges of ids, given or PARTITIONS_PER_THREAD per
+ * @note thread - which run in parallel. A message goes to the outbox of its (source partition,
+ * @note target partition) pair, so sending needs no synchronisation; between supersteps every
+ * @note target partition gathers its outboxes, combining or counting-sorting them per vertex.
+ * @note Whether a vertex is awake is kept in a bitmap; a partition without messages only visits
+ * @note the set bits of its words.
+ * @note The graph is read from all partitions at once, so run() finalizes it (finalize_graph)
+ * @note on the calling thread first; it must not change while the engine runs.
+ * @note To run on the parts of MultilevelPartitioner, relabel the graph with Partition::relabeling
+ * @note and pass Partition::part_offsets as the boundaries.
+ */
+template<typename Program, OutNeighborGraph G>
+class PregelEngine {
+    public:
+        using Value = typename Program::Value;
+        using Message = typename Program::Message;
+        static constexpr bool COMBINED = requires(Message a, Message b) { { Program::combine(a, b) } -> std::convertible_to<Message>; };
+
+        //* what compute sees of its vertex
+        class Context {
+            public:
+                int id() const { return vertex;}
+                int superstep() const { return engine.superstep;}
+                int get_number_of_vertices() const { return engine.graph.get_number_of_vertices();}
+                Value& value() { return engine.values[vertex];}
+                const Value& value() const { return engine.values[vertex];}
+
+                template<typename Function>
+                void for_each_out_neighbor(Function&& function) const { engine.graph.for_each_out_neighbor(vertex, function);}
+                int out_degree() const {
+                    int degree = 0;
+                    engine.graph.for_each_out_neighbor(vertex, [&degree](int, int) { degree++;});
+                    return degree;
+                }
+
+                void send(int target, const Message& message) { engine.send(partition, target, message);}
+                void send_to_out_neighbors(const Message& message) {
+                    engine.graph.for_each_out_neighbor(vertex, [&](int v_incoming, int) { engine.send(partition, v_incoming, message);});
+                }
+                void vote_to_halt() { halted = true;}
+
+            private:
+                friend class PregelEngine;
+                Context(PregelEngine& engine, int partition, int vertex) : engine(engine), partition(partition), vertex(vertex) {}
+
+                PregelEngine& engine;
+                int partition;
+                int vertex;
+                bool halted = false;
+        };
+
+        PregelEngine(const G& graph, Program& program, int threads = default_thread_count(),
+                std::vector<int> boundaries = {});
+
+        //! wykonuje supersteps aż do zatrzymania wszystkich wierzchołków, zwraca ich liczbę
+        int run(int max_supersteps = INT_MAX);
+
+        const std::vector<Value>& get_values() const { return values;}
+        std::vector<Value>& get_values() { return values;}
+        int get_superstep() const { return superstep;}
+        long long get_messages_sent() const { return messages_sent;}
+        int get_number_of_partitions() const { return static_cast<int>(boundaries.size()) - 1;}
+
+    private:
+        static constexpr int PARTITIONS_PER_THREAD = 4;
+
+        //* messages delivered to one partition
+        struct Inbox {
+            std::vector<int> offsets;       // bez kombinatora: wiadomości wierzchołka boundaries[p] + i
+            std::vector<Message> messages;  // z kombinatorem: jedna wiadomość na wierzchołek
+            std::vector<uint8_t> present;   // z kombinatorem: czy wierzchołek ma wiadomość
+        };
+        struct Envelope {
+            int target;
+            Message message;
+        };
+
+        const G& graph;
+        Program& program;
+        int threads;
+        std::vector<int> boundaries;                    // partycja p to wierzchołki [boundaries[p], boundaries[p + 1])
+        int range = 0;                                  // długość partycji, gdy są równe (0 - podane granice)
+        std::vector<Value> values;
+        std::vector<uint64_t> awake;                    // bit v - wierzchołek nie głosował za zatrzymaniem
+        std::vector<std::vector<Envelope>> outboxes;    // outboxes[źródło * partycje + cel]
+        std::vector<Inbox> inboxes;
+        std::vector<long long> sent;                    // wiadomości wysłane przez partycję w tym kroku
+        int superstep = 0;
+        long long messages_sent = 0;
+
+        int partition_of(int v) const {
+            if (range) return v / range;
+            return static_cast<int>(std::upper_bound(boundaries.begin(), boundaries.end(), v) - boundaries.begin()) - 1;
+        }
+        void send(int partition, int target, const Message& message) {
+            outboxes[static_cast<size_t>(partition) * get_number_of_partitions() + partition_of(target)].push_back({target, message});
+            sent[partition]++;
+        }
+        void set_awake(int v, bool state) {
+            std::atomic_ref<uint64_t> word(awake[v >> 6]);
+            const uint64_t bit = uint64_t(1) << (v & 63);
+            if (state) word.fetch_or(bit, std::memory_order_relaxed);
+            else word.fetch_and(~bit, std::memory_order_relaxed);
+        }
+        bool is_awake(int v) const {
+            return (std::atomic_ref<const uint64_t>(awake[v >> 6]).load(std::memory_order_relaxed) >> (v & 63)) & 1;
+        }
+
+        bool compute_partition(int p);
+        bool deliver(int p);
+};
+
+template<typename Program, OutNeighborGraph G>
+PregelEngine<Program, G>::PregelEngine(const G& graph, Program& program, int threads, std::vector<int> boundaries)
+    : graph(graph), program(program), threads(std::max(1, threads)), boundaries(std::move(boundaries)) {
+    const int n = graph.get_number_of_vertices();
+    if (this->boundaries.size() < 2 || this->boundaries.front() != 0 || this->boundaries.back() != n) {
+        //* equal ranges, rounded to whole words of the bitmap
+        const int count = std::max(1, std::min(this->threads * PARTITIONS_PER_THREAD, (n + 63) / 64));
+        const int size = ((n + count - 1) / count + 63) / 64 * 64;
+        this->boundaries.clear();
+        for (int begin = 0; begin < n; begin += size) this->boundaries.push_back(begin);
+        this->boundaries.push_back(n);
+        if (n == 0) this->boundaries.assign(2, 0);
+        range = std::max(size, 1);
+    }
+    const int partitions = get_number_of_partitions();
+    values.assign(n, Value{});
+    outboxes.assign(static_cast<size_t>(partitions) * partitions, {});
+    inboxes.assign(partitions, Inbox{});
+    sent.assign(partitions, 0);
+}
+
+//* runs compute on the vertices of partition p that are awake or have messages; true if any is still awake
+template<typename Program, OutNeighborGraph G>
+bool PregelEngine<Program, G>::compute_partition(int p) {
+    const int begin = boundaries[p], end = boundaries[p + 1];
+    Inbox& inbox = inboxes[p];
+    const bool has_messages = superstep > 0 && (COMBINED ? !inbox.present.empty() : inbox.offsets.back() > 0);
+    bool any_awake = false;
+    auto compute = [&](int v, MessageRange<Message> messages) {
+        Context context(*this, p, v);
+        program.compute(context, messages);
+        if (context.halted == is_awake(v)) set_awake(v, !context.halted);
+        any_awake |= !context.halted;
+    };
+
+    if (superstep > 0 && !has_messages) {
+        //* only awake vertices run, found word by word in the bitmap
+        for (int w = begin >> 6; w <= (end - 1) >> 6 && begin < end; w++) {
+            for (uint64_t word = std::atomic_ref<uint64_t>(awake[w]).load(std::memory_order_relaxed); word; word &= word - 1) {
+                const int v = w * 64 + DynamicBitset::lowest_bit(word);
+                if (v >= begin && v < end) compute(v, {});
+            }
+        }
+        return any_awake;
+    }
+
+    for (int v = begin; v < end; v++) {
+        MessageRange<Message> messages;
+        if (has_messages) {
+            const int local = v - begin;
+            if constexpr (COMBINED) {
+                if (inbox.present[local]) messages = {&inbox.messages[local], &inbox.messages[local] + 1};
+            } else {
+                messages = {inbox.messages.data() + inbox.offsets[local], inbox.messages.data() + inbox.offsets[local + 1]};
+            }
+        }
+        if (superstep > 0 && messages.empty() && !is_awake(v)) continue;
+        compute(v, messages);
+    }
+    return any_awake;
+}
+
+//* gathers the outboxes addressed to partition p; true if any message arrived
+template<typename Program, OutNeighborGraph G>
+bool PregelEngine<Program, G>::deliver(int p) {
+    const int partitions = get_number_of_partitions();
+    const int begin = boundaries[p];
+    const int size = boundaries[p + 1] - begin;
+    Inbox& inbox = inboxes[p];
+    bool arrived = false;
+
+    if constexpr (COMBINED) {
+        inbox.present.assign(size, 0);
+        inbox.messages.resize(size);
+        for (int source = 0; source < partitions; source++) {
+            std::vector<Envelope>& outbox = outboxes[static_cast<size_t>(source) * partitions + p];
+            for (const Envelope& envelope : outbox) {
+                const int local = envelope.target - begin;
+                if (inbox.present[local]) {
+                    inbox.messages[local] = Program::combine(inbox.messages[local], envelope.message);
+                } else {
+                    inbox.messages[local] = envelope.message;
+                    inbox.present[local] = 1;
+                }
+            }
+            arrived |= !outbox.empty();
+            outbox.clear();
+        }
+        if (!arrived) inbox.present.clear();
+    } else {
+        inbox.offsets.assign(size + 1, 0);
+        for (int source = 0; source < partitions; source++) {
+            for (const Envelope& envelope : outboxes[static_cast<size_t>(source) * partitions + p]) {
+                inbox.offsets[envelope.target - begin + 1]++;
+            }
+        }
+        for (int i = 0; i < size; i++) inbox.offsets[i + 1] += inbox.offsets[i];
+        inbox.messages.resize(inbox.offsets[size]);
+        std::vector<int> next(inbox.offsets.begin(), inbox.offsets.end() - 1);
+        for (int source = 0; source < partitions; source++) {
+            std::vector<Envelope>& outbox = outboxes[static_cast<size_t>(source) * partitions + p];
+            for (const Envelope& envelope : outbox) inbox.messages[next[envelope.target - begin]++] = envelope.message;
+            outbox.clear();
+        }
+        arrived = inbox.offsets[size] > 0;
+    }
+    return arrived;
+}
+
+template<typename Program, OutNeighborGraph G>
+int PregelEngine<Program, G>::run(int max_supersteps) {
+    const int n = graph.get_number_of_vertices();
+    const int partitions = get_number_of_partitions();
+    awake.assign((n + 63) / 64, 0);
+    for (Inbox& inbox : inboxes) {
+        inbox.offsets.assign(1, 0);
+        inbox.present.clear();
+    }
+    superstep = 0;
+    messages_sent = 0;
+    finalize_graph(graph);
+
+    std::vector<uint8_t> partition_awake(partitions), partition_arrived(partitions);
+    while (superstep < max_supersteps) {
+        std::fill(sent.begin(), sent.end(), 0);
+        parallel_for(0, partitions, [&](int p) { partition_awake[p] = compute_partition(p);}, threads);
+        parallel_for(0, partitions, [&](int p) { partition_arrived[p] = deliver(p);}, threads);
+        superstep++;
+
+        for (long long count : sent) messages_sent += count;
+        const bool awake_left = std::find(partition_awake.begin(), partition_awake.end(), 1) != partition_awake.end();
+        const bool in_flight = std::find(partition_arrived.begin(), partition_arrived.end(), 1) != partition_arrived.end();
+        if (!awake_left && !in_flight) break;
+    }
+    return superstep;
+}
+
+//* label propagation: every vertex ends with the smallest id that reaches it
+struct MinimumLabelProgram {
+    using Value = int;
+    using Message = int;
+
+    static Message combine(Message a, Message b) { return std::min(a, b);}
+
+    template<typename Context>
+    void compute(Context& vertex, MessageRange<Message> messages) {
+        bool changed = vertex.superstep() == 0;
+        if (changed) vertex.value() = vertex.id();
+        for (Message label : messages) {
+            if (label < vertex.value()) {
+                vertex.value() = label;
+                changed = true;
+            }
+        }
+        if (changed) vertex.send_to_out_neighbors(vertex.value());
+        vertex.vote_to_halt();
+    }
+};
+
+//* PageRank without the dangling-vertex correction, as in the Pregel paper
+struct PageRankProgram {
+    using Value = double;
+    using Message = double;
+
+    double damping = 0.85;
+    int iterations = 20;
+
+    static Message combine(Message a, Message b) { return a + b;}
+
+    template<typename Context>
+    void compute(Context& vertex, MessageRange<Message> messages) {
+        const int n = vertex.get_number_of_vertices();
+        if (vertex.superstep() == 0) {
+            vertex.value() = 1.0 / n;
+        } else {
+            double sum = 0.0;
+            for (Message share : messages) sum += share;
+            vertex.value() = (1.0 - damping) / n + damping * sum;
+        }
+        if (vertex.superstep() < iterations) {
+            const int degree = vertex.out_degree();
+            if (degree) vertex.send_to_out_neighbors(vertex.value() / degree);
+        } else {
+            vertex.vote_to_halt();
+        }
+    }
+};
+
+//! najmniejszy numer wierzchołka, z którego osiągalny jest każdy wierzchołek
+template<OutNeighborGraph G>
+std::vector<int> propagate_minimum_labels(const G& graph, int threads = default_thread_count()) {
+    MinimumLabelProgram program;
+    PregelEngine<MinimumLabelProgram, G> engine(graph, program, threads);
+    engine.run();
+    return engine.get_values();
+}
+
+std::vector<int> propagate_minimum_labels(const Graph& graph, int threads = default_thread_count()) {
+    return propagate_minimum_labels(VirtualGraph(graph), threads);
+}
+
+template<OutNeighborGraph G>
+std::vector<double> pregel_pagerank(const G& graph, double damping = 0.85, int iterations = 20,
+        int threads = default_thread_count()) {
+    PageRankProgram program;
+    program.damping = damping;
+    program.iterations = iterations;
+    PregelEngine<PageRankProgram, G> engine(graph, program, threads);
+    engine.run();
+    return engine.get_values();
+}
+
+std::vector<double> pregel_pagerank(const Graph& graph, double damping = 0.85, int iterations = 20,
+        int threads = default_thread_count()) {
+    return pregel_pagerank(VirtualGraph(graph), damping, iterations, threads);
+}
+#endif
@@ -0,0 +1,81 @@
+#ifndef RADIX_HEAP_H
+#define RADIX_HEAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Monotone priority queue of (key, value) pairs with unsigned 64-bit keys: a pushed key
+ * may not be smaller than the last popped one, which is always true in Dijkstra's algorithm.
+ * @note Bucket i > 0 holds keys whose highest bit differing from the last popped key is bit i - 1,
+ * @note so a key moves only to lower buckets and is moved at most 64 times; push is O(1),
+ * @note pop amortised O(log C) for the largest key difference C, with no comparisons between entries.
+ */
+template<typename Value>
+class RadixHeap {
+    public:
+        using Entry = std::pair<uint64_t, Value>;
+
+        bool empty() const { return count == 0;}
+        size_t size() const { return count;}
+
+        void push(uint64_t key, Value value) {
+            buckets[bucket_of(key)].emplace_back(key, value);
+            count++;
+        }
+
+        //! zdejmuje element o najmniejszym kluczu, kopiec nie może być pusty
+        Entry pop();
+
+        //! usuwa wszystko i zeruje ostatni klucz, bufory kubełków zostają do ponownego użycia
+        void clear() {
+            for (std::vector<Entry>& bucket : buckets) bucket.clear();
+            last = 0;
+            count = 0;
+        }
+
+    private:
+        static constexpr int BUCKETS = 65;
+
+        std::vector<Entry> buckets[BUCKETS];
+        uint64_t last = 0;
+        size_t count = 0;
+
+        int bucket_of(uint64_t key) const {
+            return (key == last) ? 0 : 64 - count_leading_zeros(key ^ last);
+        }
+
+        static int count_leading_zeros(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_clzll(word);
+#else
+            int count = 0;
+            for (uint64_t bit = uint64_t(1) << 63; !(word & bit); bit >>= 1) count++;
+            return count;
+#endif
+        }
+};
+
+template<typename Value>
+typename RadixHeap<Value>::Entry RadixHeap<Value>::pop() {
+    if (buckets[0].empty()) {
+        int i = 1;
+        while (buckets[i].empty()) i++;
+
+        uint64_t smallest = buckets[i][0].first;
+        for (const Entry& entry : buckets[i]) {
+            if (entry.first < smallest) smallest = entry.first;
+        }
+        last = smallest;
+        for (const Entry& entry : buckets[i]) buckets[bucket_of(entry.first)].push_back(entry);
+        buckets[i].clear();
+    }
+
+    const Entry entry = buckets[0].back();
+    buckets[0].pop_back();
+    count--;
+    return entry;
+}
+#endif
@@ -0,0 +1,213 @@
+#ifndef REACHABILITY_INDEX_H
+#define REACHABILITY_INDEX_H
+
+#include "Graph.h"
+#include "GraphConcept.h"
+#include "Condensation.h"
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+/**
+ * @brief GRAIL reachability index over the condensation of a graph: O(d * (n + m)) to build,
+ * 3d + 1 ints per component besides the condensation itself, and most "can u reach v?"
+ * queries answered from these labels alone.
+ * @note Every one of the d random DFS traversals gives a component c an interval
+ * @note [low, post]: post is its post-order number and low the smallest post in its subtree.
+ * @note If u reaches v, the interval of v lies inside the interval of u in every traversal,
+ * @note so one interval outside answers "no". Together with the topological filters (Tarjan ids
+ * @note and the level - the longest path to a sink) it rejects nearly all unreachable pairs.
+ * @note Every traversal also keeps the interval [tree_low, post] of the DFS tree below c: a target
+ * @note inside it is a descendant in that tree, which answers "yes".
+ * @note Other queries run a DFS over the condensation that enters only children whose labels
+ * @note still contain the target, and stops at the first one whose tree holds the target.
+ * @note reaches(u, v) uses scratch buffers of the index and so is not thread safe; threads
+ * @note should call reaches(u, v, scratch), each with its own Scratch.
+ */
+class ReachabilityIndex {
+    public:
+        static constexpr int DEFAULT_TRAVERSALS = 3;
+
+        //* buffers of the guided DFS, reused by all queries made with them
+        struct Scratch {
+            std::vector<uint32_t> mark;
+            uint32_t epoch = 0;
+            std::vector<int> stack;
+            long long label_answers = 0;    //* queries answered without a search
+            long long searches = 0;
+        };
+
+        ReachabilityIndex(int traversals = DEFAULT_TRAVERSALS, unsigned seed = 1)
+            : traversals(traversals < 1 ? 1 : traversals), seed(seed) {}
+
+        template<OutNeighborGraph G>
+        void build(const G& graph);
+        void build(const Graph& graph) { build(VirtualGraph(graph));}
+
+        //! czy istnieje ścieżka z v_outgoing do v_incoming (każdy wierzchołek osiąga sam siebie)
+        bool reaches(int v_outgoing, int v_incoming) const { return reaches(v_outgoing, v_incoming, scratch);}
+        bool reaches(int v_outgoing, int v_incoming, Scratch& buffers) const;
+
+        const SccResult& get_components() const { return scc;}
+        const Scratch& get_statistics() const { return scratch;}
+        size_t memory_usage() const;
+
+    private:
+        static constexpr int LABEL = 3;  // low, post, tree_low
+
+        int traversals;
+        unsigned seed;
+        SccResult scc;
+        std::vector<int> offsets;       // krawędzie kondensacji w postaci CSR
+        std::vector<int> successors;
+        std::vector<int> level;
+        std::vector<int> labels;        // 3 * traversals liczb na komponent: low, post, tree_low, low, post...
+        mutable Scratch scratch;
+
+        //! czy przedziały inner leżą wewnątrz przedziałów outer we wszystkich przejściach
+        bool contains(int outer, int inner) const {
+            const int *a = labels.data() + static_cast<size_t>(outer) * LABEL * traversals;
+            const int *b = labels.data() + static_cast<size_t>(inner) * LABEL * traversals;
+            for (int i = 0; i < LABEL * traversals; i += LABEL) {
+                if (b[i] < a[i] || b[i + 1] > a[i + 1]) return false;
+            }
+            return true;
+        }
+
+        //* cheap tests: false means "certainly not reachable"
+        bool may_reach(int from, int to) const {
+            return to < from && level[to] < level[from] && contains(from, to);
+        }
+
+        //* certain reachability: to lies in the DFS subtree of from in some traversal
+        bool tree_reaches(int from, int to) const {
+            const int *a = labels.data() + static_cast<size_t>(from) * LABEL * traversals;
+            const int *b = labels.data() + static_cast<size_t>(to) * LABEL * traversals;
+            for (int i = 0; i < LABEL * traversals; i += LABEL) {
+                if (a[i + 2] <= b[i + 1] && b[i + 1] <= a[i + 1]) return true;
+            }
+            return false;
+        }
+
+        void label(int traversal, std::mt19937& random);
+};
+
+template<OutNeighborGraph G>
+void ReachabilityIndex::build(const G& graph) {
+    //* the rows are shuffled by label(), so the index takes the arrays over instead of sharing them
+    condense(graph).release(scc, offsets, successors);
+    const int count = scc.count;
+
+    //* successors have lower ids, so their levels are known before their predecessors'
+    level.assign(count, 0);
+    for (int c = 0; c < count; c++) {
+        for (int i = offsets[c]; i < offsets[c + 1]; i++) level[c] = std::max(level[c], level[successors[i]] + 1);
+    }
+
+    labels.assign(static_cast<size_t>(count) * LABEL * traversals, 0);
+    std::mt19937 random(seed);
+    for (int t = 0; t < traversals; t++) label(t, random);
+
+    scratch = Scratch();
+}
+
+/**
+ * @brief One random DFS of the condensation (roots and children in random order), iterative.
+ * @note Shuffling the rows costs O(m) and leaves the edge set unchanged.
+ */
+void ReachabilityIndex::label(int traversal, std::mt19937& random) {
+    const int count = scc.count;
+    for (int c = 0; c < count; c++) {
+        std::shuffle(successors.begin() + offsets[c], successors.begin() + offsets[c + 1], random);
+    }
+    std::vector<int> roots(count);
+    std::iota(roots.begin(), roots.end(), 0);
+    std::shuffle(roots.begin(), roots.end(), random);
+
+    std::vector<int> next_child(count, -1);  // -1 - komponent jeszcze nieodwiedzony
+    std::vector<int> stack;
+    int post = 0;
+    auto low_of = [&](int c) -> int& { return labels[(static_cast<size_t>(c) * traversals + traversal) * LABEL];};
+    auto post_of = [&](int c) -> int& { return labels[(static_cast<size_t>(c) * traversals + traversal) * LABEL + 1];};
+    auto tree_low_of = [&](int c) -> int& { return labels[(static_cast<size_t>(c) * traversals + traversal) * LABEL + 2];};
+
+    for (int root : roots) {
+        if (next_child[root] != -1) continue;
+        next_child[root] = offsets[root];
+        low_of(root) = count;
+        tree_low_of(root) = post;
+        stack.push_back(root);
+
+        while (!stack.empty()) {
+            const int c = stack.back();
+            if (next_child[c] < offsets[c + 1]) {
+                const int child = successors[next_child[c]++];
+                if (next_child[child] == -1) {
+                    next_child[child] = offsets[child];
+                    low_of(child) = count;
+                    tree_low_of(child) = post;
+                    stack.push_back(child);
+                } else {
+                    low_of(c) = std::min(low_of(c), low_of(child));
+                }
+                continue;
+            }
+
+            stack.pop_back();
+            post_of(c) = post++;
+            low_of(c) = std::min(low_of(c), post_of(c));
+            if (!stack.empty()) low_of(stack.back()) = std::min(low_of(stack.back()), low_of(c));
+        }
+    }
+}
+
+bool ReachabilityIndex::reaches(int v_outgoing, int v_incoming, Scratch& buffers) const {
+    const int from = scc.component[v_outgoing];
+    const int to = scc.component[v_incoming];
+    if (from == to) {
+        buffers.label_answers++;
+        return true;
+    }
+    if (!may_reach(from, to)) {
+        buffers.label_answers++;
+        return false;
+    }
+    if (tree_reaches(from, to)) {
+        buffers.label_answers++;
+        return true;
+    }
+
+    buffers.searches++;
+    if (buffers.mark.size() != static_cast<size_t>(scc.count)) {
+        buffers.mark.assign(scc.count, 0);
+        buffers.epoch = 0;
+    }
+    if (++buffers.epoch == 0) {
+        std::fill(buffers.mark.begin(), buffers.mark.end(), 0);
+        buffers.epoch = 1;
+    }
+
+    buffers.stack.clear();
+    buffers.stack.push_back(from);
+    buffers.mark[from] = buffers.epoch;
+    while (!buffers.stack.empty()) {
+        const int c = buffers.stack.back();
+        buffers.stack.pop_back();
+        for (int i = offsets[c]; i < offsets[c + 1]; i++) {
+            const int child = successors[i];
+            if (child == to || tree_reaches(child, to)) return true;
+            if (buffers.mark[child] == buffers.epoch || !may_reach(child, to)) continue;
+            buffers.mark[child] = buffers.epoch;
+            buffers.stack.push_back(child);
+        }
+    }
+    return false;
+}
+
+size_t ReachabilityIndex::memory_usage() const {
+    return (scc.component.capacity() + offsets.capacity() + successors.capacity() + level.capacity() +
+            labels.capacity()) * sizeof(int);
+}
+#endif
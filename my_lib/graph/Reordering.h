@@ -0,0 +1,295 @@
+#ifndef REORDERING_H
+#define REORDERING_H
+
+#include "Graph.h"
+#include "GraphAsCSR.h"
+#include <algorithm>
+#include <vector>
+
+enum class VertexOrder {
+    DEGREE,     //* hubs first, by decreasing in + out degree
+    BFS,        //* breadth-first order, every component from its highest-degree vertex
+    RCM,        //* Reverse Cuthill-McKee - small bandwidth, neighbours get close ids
+    GORDER      //* Gorder-lite - greedily places vertices sharing edges/in-neighbours in one window
+};
+
+/**
+ * @brief Permutation of vertex ids: new_id[old] and old_id[new].
+ */
+struct Relabeling {
+    std::vector<int> new_id;
+    std::vector<int> old_id;
+
+    int to_new(int v) const { return new_id[v];}
+    int to_original(int v) const { return old_id[v];}
+
+    //! przepisuje wynik policzony na grafie po zmianie numeracji do starej numeracji
+    template<typename T>
+    std::vector<T> to_original(const std::vector<T>& values) const {
+        std::vector<T> result(values.size());
+        for (size_t v = 0; v < values.size(); v++) result[old_id[v]] = values[v];
+        return result;
+    }
+};
+
+/**
+ * @brief Undirected view (out + in neighbours) of a graph in CSR form, used by the orderings.
+ */
+struct SymmetricAdjacency {
+    std::vector<int> offsets;
+    std::vector<int> targets;
+
+    SymmetricAdjacency(const Graph& graph) : offsets(graph.get_number_of_vertices() + 1, 0) {
+        const int n = graph.get_number_of_vertices();
+        for (int v = 0; v < n; v++) {
+            graph.for_each_emanating(v, [&](int v_incoming, int) {
+                if (v_incoming == v) return;
+                offsets[v + 1]++;
+                offsets[v_incoming + 1]++;
+            });
+        }
+        for (int v = 0; v < n; v++) offsets[v + 1] += offsets[v];
+
+        targets.resize(offsets[n]);
+        std::vector<int> next(offsets.begin(), offsets.end() - 1);
+        for (int v = 0; v < n; v++) {
+            graph.for_each_emanating(v, [&](int v_incoming, int) {
+                if (v_incoming == v) return;
+                targets[next[v]++] = v_incoming;
+                targets[next[v_incoming]++] = v;
+            });
+        }
+    }
+
+    int degree(int v) const { return offsets[v + 1] - offsets[v];}
+};
+
+/**
+ * @brief Greedy Gorder: the next vertex is the one with most links to the last WINDOW placed
+ * vertices. A link is an edge in any direction or a common in-neighbour (a "sibling").
+ * @note Scores are kept in a bucket queue with +1/-1 updates (the "unit heap" of the
+ * @note Gorder paper). Siblings are taken only through in-neighbours of degree at most
+ * @note HUB_LIMIT, so a single hub does not make the pass quadratic.
+ */
+class GorderLite {
+    public:
+        static constexpr int WINDOW = 5;
+        static constexpr int HUB_LIMIT = 64;
+
+        GorderLite(const Graph& graph, const SymmetricAdjacency& symmetric);
+        std::vector<int> order();
+
+    private:
+        const SymmetricAdjacency& symmetric;
+        int n;
+        std::vector<int> out_offsets, out_targets; // kopia krawędzi wychodzących
+        std::vector<int> in_offsets, in_sources;   // krawędzie wchodzące (transpozycja)
+
+        std::vector<int> score;
+        std::vector<int> prev, next;   // listy dwukierunkowe wierzchołków o tym samym wyniku
+        std::vector<int> bucket_head;
+        std::vector<bool> placed;
+        int top = 0;
+
+        void unlink(int v);
+        void link(int v);
+        void change(int v, int delta);
+        void update_neighbourhood(int v, int delta);
+};
+
+GorderLite::GorderLite(const Graph& graph, const SymmetricAdjacency& symmetric)
+        : symmetric(symmetric), n(graph.get_number_of_vertices()),
+          out_offsets(n + 1, 0), in_offsets(n + 1, 0) {
+    for (int v = 0; v < n; v++) {
+        graph.for_each_emanating(v, [&](int v_incoming, int) {
+            out_targets.push_back(v_incoming);
+            in_offsets[v_incoming + 1]++;
+        });
+        out_offsets[v + 1] = static_cast<int>(out_targets.size());
+    }
+    for (int v = 0; v < n; v++) in_offsets[v + 1] += in_offsets[v];
+
+    in_sources.resize(out_targets.size());
+    std::vector<int> fill(in_offsets.begin(), in_offsets.end() - 1);
+    for (int v = 0; v < n; v++) {
+        for (int i = out_offsets[v]; i < out_offsets[v + 1]; i++) in_sources[fill[out_targets[i]]++] = v;
+    }
+}
+
+void GorderLite::unlink(int v) {
+    if (prev[v] >= 0) next[prev[v]] = next[v];
+    else bucket_head[score[v]] = next[v];
+    if (next[v] >= 0) prev[next[v]] = prev[v];
+}
+
+void GorderLite::link(int v) {
+    if (score[v] >= static_cast<int>(bucket_head.size())) bucket_head.resize(score[v] + 1, -1);
+    prev[v] = -1;
+    next[v] = bucket_head[score[v]];
+    if (next[v] >= 0) prev[next[v]] = v;
+    bucket_head[score[v]] = v;
+    if (score[v] > top) top = score[v];
+}
+
+void GorderLite::change(int v, int delta) {
+    if (placed[v]) return;
+    unlink(v);
+    score[v] += delta;
+    link(v);
+}
+
+void GorderLite::update_neighbourhood(int v, int delta) {
+    for (int i = symmetric.offsets[v]; i < symmetric.offsets[v + 1]; i++) change(symmetric.targets[i], delta);
+
+    for (int i = in_offsets[v]; i < in_offsets[v + 1]; i++) {
+        const int parent = in_sources[i];
+        if (out_offsets[parent + 1] - out_offsets[parent] > HUB_LIMIT) continue;
+        for (int j = out_offsets[parent]; j < out_offsets[parent + 1]; j++) {
+            if (out_targets[j] != v) change(out_targets[j], delta);
+        }
+    }
+}
+
+std::vector<int> GorderLite::order() {
+    std::vector<int> result;
+    result.reserve(n);
+    if (n == 0) return result;
+
+    score.assign(n, 0);
+    prev.assign(n, -1);
+    next.assign(n, -1);
+    bucket_head.assign(1, -1);
+    placed.assign(n, false);
+    top = 0;
+    for (int v = n - 1; v >= 0; v--) link(v);
+
+    //* vertices with score 0 are taken by decreasing degree (start of a new region)
+    std::vector<int> by_degree(n);
+    for (int v = 0; v < n; v++) by_degree[v] = v;
+    std::stable_sort(by_degree.begin(), by_degree.end(), [this](int a, int b) {
+        return symmetric.degree(a) > symmetric.degree(b);
+    });
+    size_t fallback = 0;
+
+    while (static_cast<int>(result.size()) < n) {
+        while (top > 0 && bucket_head[top] < 0) top--;
+
+        int v;
+        if (top > 0) {
+            v = bucket_head[top];
+        } else {
+            while (placed[by_degree[fallback]]) fallback++;
+            v = by_degree[fallback];
+        }
+
+        unlink(v);
+        placed[v] = true;
+        result.push_back(v);
+
+        update_neighbourhood(v, +1);
+        if (result.size() > WINDOW) update_neighbourhood(result[result.size() - WINDOW - 1], -1);
+    }
+    return result;
+}
+
+/**
+ * @brief Computes the new numbering of vertices for the given strategy, in O(n + m)
+ * (O(n log n + m) for DEGREE and GORDER because of sorting).
+ */
+Relabeling compute_relabeling(const Graph& graph, VertexOrder strategy) {
+    const int n = graph.get_number_of_vertices();
+    const SymmetricAdjacency symmetric(graph);
+    std::vector<int> order; // order[i] - stary numer wierzchołka, który dostaje numer i
+    order.reserve(n);
+
+    auto by_degree = [&symmetric](int a, int b) { return symmetric.degree(a) < symmetric.degree(b);};
+
+    switch (strategy) {
+        case VertexOrder::DEGREE: {
+            for (int v = 0; v < n; v++) order.push_back(v);
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return by_degree(b, a);});
+            break;
+        }
+
+        case VertexOrder::BFS:
+        case VertexOrder::RCM: {
+            //* BFS starts every component from its highest-degree vertex, Cuthill-McKee from
+            //* the lowest-degree one and visits neighbours by increasing degree
+            const bool cuthill_mckee = strategy == VertexOrder::RCM;
+            std::vector<int> roots(n);
+            for (int v = 0; v < n; v++) roots[v] = v;
+            std::stable_sort(roots.begin(), roots.end(), [&](int a, int b) {
+                return cuthill_mckee ? by_degree(a, b) : by_degree(b, a);
+            });
+
+            std::vector<bool> visited(n, false);
+            std::vector<int> neighbours;
+            for (int root : roots) {
+                if (visited[root]) continue;
+                visited[root] = true;
+                size_t head = order.size();
+                order.push_back(root);
+
+                while (head < order.size()) {
+                    const int v = order[head++];
+                    neighbours.clear();
+                    for (int i = symmetric.offsets[v]; i < symmetric.offsets[v + 1]; i++) {
+                        const int mate = symmetric.targets[i];
+                        if (!visited[mate]) {
+                            visited[mate] = true;
+                            neighbours.push_back(mate);
+                        }
+                    }
+                    if (cuthill_mckee) std::stable_sort(neighbours.begin(), neighbours.end(), by_degree);
+                    order.insert(order.end(), neighbours.begin(), neighbours.end());
+                }
+            }
+            if (cuthill_mckee) std::reverse(order.begin(), order.end());
+            break;
+        }
+
+        case VertexOrder::GORDER: {
+            GorderLite gorder(graph, symmetric);
+            order = gorder.order();
+            break;
+        }
+    }
+
+    Relabeling relabeling;
+    relabeling.old_id = order;
+    relabeling.new_id.assign(n, -1);
+    for (int i = 0; i < n; i++) relabeling.new_id[order[i]] = i;
+    return relabeling;
+}
+
+/**
+ * @brief Copies every edge u -> v of source as new_id[u] -> new_id[v] into an empty target
+ * of the same size (any backend, e.g. GraphAsMatrix).
+ */
+void apply_relabeling(const Graph& source, const Relabeling& relabeling, Graph& target) {
+    for (int v = 0; v < source.get_number_of_vertices(); v++) {
+        const int new_v = relabeling.new_id[v];
+        source.for_each_emanating(v, [&](int v_incoming, int weight) {
+            target.add_edge(new_v, relabeling.new_id[v_incoming], weight);
+        });
+    }
+}
+
+/**
+ * @brief Permuted copy of the graph in CSR form; relabeling receives the permutation
+ * needed to translate results back (Relabeling::to_original).
+ */
+GraphAsCSR reorder(const Graph& graph, VertexOrder strategy, Relabeling& relabeling) {
+    relabeling = compute_relabeling(graph, strategy);
+
+    std::vector<EdgeRecord> edges;
+    edges.reserve(graph.get_number_of_edges());
+    for (int v = 0; v < graph.get_number_of_vertices(); v++) {
+        const int new_v = relabeling.new_id[v];
+        graph.for_each_emanating(v, [&](int v_incoming, int weight) {
+            edges.push_back({new_v, relabeling.new_id[v_incoming], weight});
+        });
+    }
+    return GraphAsCSR(graph.get_number_of_vertices(), edges);
+}
+#endif
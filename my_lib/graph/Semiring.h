@@ -0,0 +1,88 @@
+#ifndef SEMIRING_H
+#define SEMIRING_H
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+
+/**
+ * @brief Semirings for SemiringEngine: a vector value x[u] times an edge u -> v of weight w
+ * gives multiply(x[u], w), and the products arriving at v are summed with add.
+ * @note zero() is the neutral element of add and must stay zero under multiply; a value is
+ * @note absorbing when add can no longer change it (true for boolean), which lets the pull
+ * @note kernel skip it. accumulate_atomic(target, x) does target = add(target, x) from many
+ * @note threads at once and tells whether target changed.
+ * @note KIND lets the engine pick a vectorised kernel; own semirings use GENERIC.
+ */
+enum class SemiringKind { GENERIC, BOOLEAN, MIN_PLUS, PLUS_TIMES, PLUS_FIRST };
+
+//* or / and: reachability, BFS frontiers
+struct BooleanSemiring {
+    using Value = uint8_t;
+    static constexpr SemiringKind KIND = SemiringKind::BOOLEAN;
+
+    static constexpr Value zero() { return 0;}
+    static Value add(Value a, Value b) { return a | b;}
+    static Value multiply(Value x, int) { return x;}
+    static bool is_absorbing(Value a) { return a != 0;}
+
+    static bool accumulate_atomic(Value& target, Value x) {
+        if (!x) return false;
+        return std::atomic_ref<Value>(target).exchange(1, std::memory_order_relaxed) == 0;
+    }
+};
+
+//* min / +: shortest paths, zero() is the infinite distance
+struct MinPlusSemiring {
+    using Value = long long;
+    static constexpr SemiringKind KIND = SemiringKind::MIN_PLUS;
+
+    static constexpr Value zero() { return LLONG_MAX;}
+    static Value add(Value a, Value b) { return a < b ? a : b;}
+    static Value multiply(Value x, int weight) { return (x == zero()) ? x : x + weight;}
+    static bool is_absorbing(Value) { return false;}
+
+    static bool accumulate_atomic(Value& target, Value x) {
+        std::atomic_ref<Value> slot(target);
+        Value current = slot.load(std::memory_order_relaxed);
+        while (x < current) {
+            if (slot.compare_exchange_weak(current, x, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+};
+
+//* + / *: weighted sums over the edge weights
+struct PlusTimesSemiring {
+    using Value = double;
+    static constexpr SemiringKind KIND = SemiringKind::PLUS_TIMES;
+
+    static constexpr Value zero() { return 0.0;}
+    static Value add(Value a, Value b) { return a + b;}
+    static Value multiply(Value x, int weight) { return x * weight;}
+    static bool is_absorbing(Value) { return false;}
+
+    static bool accumulate_atomic(Value& target, Value x) {
+        if (x == 0.0) return false;
+        std::atomic_ref<Value>(target).fetch_add(x, std::memory_order_relaxed);
+        return true;
+    }
+};
+
+//* + / first: sums of x over the in-edges, the weights are ignored (PageRank, path counting)
+struct PlusFirstSemiring {
+    using Value = double;
+    static constexpr SemiringKind KIND = SemiringKind::PLUS_FIRST;
+
+    static constexpr Value zero() { return 0.0;}
+    static Value add(Value a, Value b) { return a + b;}
+    static Value multiply(Value x, int) { return x;}
+    static bool is_absorbing(Value) { return false;}
+
+    static bool accumulate_atomic(Value& target, Value x) {
+        if (x == 0.0) return false;
+        std::atomic_ref<Value>(target).fetch_add(x, std::memory_order_relaxed);
+        return true;
+    }
+};
+#endif
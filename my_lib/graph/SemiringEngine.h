@@ -0,0 +1,460 @@
+#ifndef SEMIRING_ENGINE_H
+#define SEMIRING_ENGINE_H
+
+#include "../../include/SDL2/SDL_cpuinfo.h"
+#include "Graph.h"
+#include "GraphConcept.h"
+#include "Parallel.h"
+#include "Semiring.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SEMIRING_ENGINE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SEMIRING_ENGINE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SEMIRING_ENGINE_TARGET(isa)
+#endif
+
+/**
+ * @brief Adjacency matrix of a graph for the semiring kernels, copied once from any backend:
+ * rows (out-edges, for push) and columns (in-edges, for pull) as CSR arrays of targets and weights.
+ * @note When the graph is dense enough that a bit per cell costs no more than the column
+ * @note array (m >= n * n / 32), the columns are also kept as bitsets and the boolean pull
+ * @note becomes an AND of two bitsets, 256 bits at a time.
+ * @note The row reductions of the pull use AVX2 gathers when the processor has them.
+ */
+class SemiringMatrix {
+    public:
+        enum class Kernel { SCALAR, AVX2 };
+
+        template<OutNeighborGraph G>
+        SemiringMatrix(const G& graph, Kernel kernel = detect_kernel());
+        SemiringMatrix(const Graph& graph, Kernel kernel = detect_kernel()) : SemiringMatrix(VirtualGraph(graph), kernel) {}
+
+        static Kernel detect_kernel();
+
+        int get_number_of_vertices() const { return n;}
+        long long get_number_of_edges() const { return static_cast<long long>(targets.size());}
+        int out_degree(int v) const { return out_offsets[v + 1] - out_offsets[v];}
+        bool has_bitsets() const { return !in_bits.empty();}
+        int get_words() const { return words;}
+
+        //* out-edges of u: targets / weights [out_begin(u), out_end(u))
+        int out_begin(int u) const { return out_offsets[u];}
+        int out_end(int u) const { return out_offsets[u + 1];}
+        int target(int edge) const { return targets[edge];}
+        int weight(int edge) const { return out_weights[edge];}
+
+        //* in-edges of v: sources / weights [in_begin(v), in_end(v))
+        int in_begin(int v) const { return in_offsets[v];}
+        int in_end(int v) const { return in_offsets[v + 1];}
+        int source(int edge) const { return sources[edge];}
+        int in_weight(int edge) const { return in_weights[edge];}
+
+        //! suma x[u] (razy waga, gdy weighted) po krawędziach wchodzących do v
+        double sum_in_row(int v, const double *x, bool weighted) const;
+        //! minimum x[u] + waga po krawędziach wchodzących do v, LLONG_MAX dla nieskończoności
+        long long min_plus_in_row(int v, const long long *x) const;
+        //! czy któryś bit x jest ustawiony w kolumnie v (tylko gdy has_bitsets())
+        bool in_row_intersects(int v, const uint64_t *x_bits) const;
+
+    private:
+        int n;
+        int words;
+        Kernel kernel;
+        std::vector<int> out_offsets;
+        std::vector<int> targets;
+        std::vector<int> out_weights;
+        std::vector<int> in_offsets;
+        std::vector<int> sources;
+        std::vector<int> in_weights;
+        std::vector<uint64_t> in_bits;   // kolumny jako bitsety po words słów, puste dla grafów rzadkich
+
+#ifdef SEMIRING_ENGINE_X86
+        static double sum_avx2(const int *sources, const int *weights, int count, const double *x);
+        static long long min_plus_avx2(const int *sources, const int *weights, int count, const long long *x);
+        static bool intersects_avx2(const uint64_t *a, const uint64_t *b, int words);
+#endif
+};
+
+SemiringMatrix::Kernel SemiringMatrix::detect_kernel() {
+#ifdef SEMIRING_ENGINE_X86
+    if (SDL_HasAVX2()) return Kernel::AVX2;
+#endif
+    return Kernel::SCALAR;
+}
+
+template<OutNeighborGraph G>
+SemiringMatrix::SemiringMatrix(const G& graph, Kernel kernel)
+        : n(graph.get_number_of_vertices()), words((n + 63) / 64), kernel(kernel), out_offsets(n + 1, 0), in_offsets(n + 1, 0) {
+    for (int u = 0; u < n; u++) {
+        graph.for_each_out_neighbor(u, [&](int v, int weight) {
+            targets.push_back(v);
+            out_weights.push_back(weight);
+            in_offsets[v + 1]++;
+        });
+        out_offsets[u + 1] = static_cast<int>(targets.size());
+    }
+
+    //* columns by a counting sort, sources come in increasing order
+    for (int v = 0; v < n; v++) in_offsets[v + 1] += in_offsets[v];
+    sources.resize(targets.size());
+    in_weights.resize(targets.size());
+    std::vector<int> next(in_offsets.begin(), in_offsets.end() - 1);
+    for (int u = 0; u < n; u++) {
+        for (int e = out_offsets[u]; e < out_offsets[u + 1]; e++) {
+            const int slot = next[targets[e]]++;
+            sources[slot] = u;
+            in_weights[slot] = out_weights[e];
+        }
+    }
+
+    if (static_cast<double>(n) * words * sizeof(uint64_t) <= static_cast<double>(targets.size()) * sizeof(int)) {
+        in_bits.assign(static_cast<size_t>(n) * words, 0);
+        for (int v = 0; v < n; v++) {
+            uint64_t *column = in_bits.data() + static_cast<size_t>(v) * words;
+            for (int e = in_offsets[v]; e < in_offsets[v + 1]; e++) column[sources[e] >> 6] |= uint64_t(1) << (sources[e] & 63);
+        }
+    }
+}
+
+#ifdef SEMIRING_ENGINE_X86
+SEMIRING_ENGINE_TARGET("avx2")
+double SemiringMatrix::sum_avx2(const int *sources, const int *weights, int count, const double *x) {
+    //* the masked gathers with an explicit source avoid reading an uninitialised register
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    __m256d sum = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sources + i));
+        __m256d values = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), x, index, all, 8);
+        if (weights) values = _mm256_mul_pd(values, _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i))));
+        sum = _mm256_add_pd(sum, values);
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, sum);
+    double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < count; i++) total += weights ? x[sources[i]] * weights[i] : x[sources[i]];
+    return total;
+}
+
+SEMIRING_ENGINE_TARGET("avx2")
+long long SemiringMatrix::min_plus_avx2(const int *sources, const int *weights, int count, const long long *x) {
+    const __m256i infinite = _mm256_set1_epi64x(LLONG_MAX);
+    __m256i best = infinite;
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sources + i));
+        const __m256i values = _mm256_mask_i32gather_epi64(infinite, reinterpret_cast<const long long*>(x), index, _mm256_set1_epi64x(-1), 8);
+        const __m256i w = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i)));
+        const __m256i candidate = _mm256_blendv_epi8(_mm256_add_epi64(values, w), infinite, _mm256_cmpeq_epi64(values, infinite));
+        best = _mm256_blendv_epi8(best, candidate, _mm256_cmpgt_epi64(best, candidate));
+    }
+    alignas(32) long long lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), best);
+    long long result = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+    for (; i < count; i++) {
+        if (x[sources[i]] != LLONG_MAX) result = std::min(result, x[sources[i]] + weights[i]);
+    }
+    return result;
+}
+
+SEMIRING_ENGINE_TARGET("avx2")
+bool SemiringMatrix::intersects_avx2(const uint64_t *a, const uint64_t *b, int words) {
+    int i = 0;
+    for (; i + 4 <= words; i += 4) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        if (!_mm256_testz_si256(x, y)) return true;
+    }
+    for (; i < words; i++) {
+        if (a[i] & b[i]) return true;
+    }
+    return false;
+}
+#endif
+
+double SemiringMatrix::sum_in_row(int v, const double *x, bool weighted) const {
+    const int begin = in_offsets[v];
+    const int count = in_offsets[v + 1] - begin;
+#ifdef SEMIRING_ENGINE_X86
+    if (kernel == Kernel::AVX2) return sum_avx2(sources.data() + begin, weighted ? in_weights.data() + begin : nullptr, count, x);
+#endif
+    double total = 0.0;
+    for (int e = begin; e < begin + count; e++) total += weighted ? x[sources[e]] * in_weights[e] : x[sources[e]];
+    return total;
+}
+
+long long SemiringMatrix::min_plus_in_row(int v, const long long *x) const {
+    const int begin = in_offsets[v];
+    const int count = in_offsets[v + 1] - begin;
+#ifdef SEMIRING_ENGINE_X86
+    if (kernel == Kernel::AVX2) return min_plus_avx2(sources.data() + begin, in_weights.data() + begin, count, x);
+#endif
+    long long result = LLONG_MAX;
+    for (int e = begin; e < begin + count; e++) {
+        if (x[sources[e]] != LLONG_MAX) result = std::min(result, x[sources[e]] + in_weights[e]);
+    }
+    return result;
+}
+
+bool SemiringMatrix::in_row_intersects(int v, const uint64_t *x_bits) const {
+    const uint64_t *column = in_bits.data() + static_cast<size_t>(v) * words;
+#ifdef SEMIRING_ENGINE_X86
+    if (kernel == Kernel::AVX2) return intersects_avx2(column, x_bits, words);
+#endif
+    for (int i = 0; i < words; i++) {
+        if (column[i] & x_bits[i]) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Vector of a semiring: dense values (zero() outside of active) and the list of active
+ * indices. As input of a multiplication active are the non-zero entries, as output the
+ * entries that changed.
+ */
+template<typename Value>
+struct SemiringVector {
+    std::vector<Value> dense;
+    std::vector<int> active;
+
+    SemiringVector() = default;
+    SemiringVector(int n, Value zero) : dense(n, zero) {}
+
+    void set(int index, Value value) {
+        dense[index] = value;
+        active.push_back(index);
+    }
+
+    //! zeruje aktywne pozycje, O(active)
+    void clear(Value zero) {
+        for (int index : active) dense[index] = zero;
+        active.clear();
+    }
+};
+
+/**
+ * @brief y = y + x * A over a semiring S, where (x * A)[v] sums multiply(x[u], w) over the
+ * edges u -> v - one step of BFS, Bellman-Ford, PageRank, reachability...
+ * @note push scatters the out-edges of the active entries of x (atomic accumulation, cost
+ * @note proportional to their out-degrees); pull gathers the in-edges of every vertex
+ * @note (no atomics, vectorised reductions, absorbing entries of y are skipped).
+ * @note multiply() picks push while the active entries have fewer than m / PULL_RATIO out-edges
+ * @note and fewer than n / PULL_RATIO entries are active, pull otherwise.
+ * @note Both split the work into chunks handed to parallel_for; y.active gets the changed indices.
+ */
+template<typename S>
+class SemiringEngine {
+    public:
+        using Value = typename S::Value;
+        using Vector = SemiringVector<Value>;
+        enum class Direction { PUSH, PULL };
+
+        static constexpr int PULL_RATIO = 14;
+        static constexpr int CHUNK = 1024;
+
+        SemiringEngine(const SemiringMatrix& matrix, int threads = default_thread_count())
+            : matrix(matrix), threads(threads), changed_flags(matrix.get_number_of_vertices(), 0) {}
+
+        Vector make_vector() const { return Vector(matrix.get_number_of_vertices(), S::zero());}
+
+        Direction multiply(const Vector& x, Vector& y);
+        void push(const Vector& x, Vector& y);
+        void pull(const Vector& x, Vector& y);
+
+    private:
+        const SemiringMatrix& matrix;
+        int threads;
+        std::vector<uint8_t> changed_flags;      // czy wierzchołek jest już na liście zmienionych (push)
+        std::vector<uint64_t> x_bits;            // x jako bitset dla logicznego pull
+        std::vector<std::vector<int>> changed;   // zmienione pozycje, po liście na fragment
+
+        Value reduce_column(int v, const Vector& x) const;
+        void collect(Vector& y, int chunks);
+};
+
+template<typename S>
+typename SemiringEngine<S>::Direction SemiringEngine<S>::multiply(const Vector& x, Vector& y) {
+    const int n = matrix.get_number_of_vertices();
+    long long out_edges = 0;
+    for (int u : x.active) out_edges += matrix.out_degree(u);
+
+    if (static_cast<long long>(x.active.size()) * PULL_RATIO > n || out_edges * PULL_RATIO > matrix.get_number_of_edges()) {
+        pull(x, y);
+        return Direction::PULL;
+    }
+    push(x, y);
+    return Direction::PUSH;
+}
+
+template<typename S>
+void SemiringEngine<S>::push(const Vector& x, Vector& y) {
+    const int count = static_cast<int>(x.active.size());
+    const int chunks = (count + CHUNK - 1) / CHUNK;
+    if (static_cast<int>(changed.size()) < chunks) changed.resize(chunks);
+
+    parallel_for(0, chunks, [&](int chunk) {
+        std::vector<int>& out = changed[chunk];
+        const int end = std::min(count, (chunk + 1) * CHUNK);
+        for (int i = chunk * CHUNK; i < end; i++) {
+            const int u = x.active[i];
+            const Value value = x.dense[u];
+            for (int e = matrix.out_begin(u); e < matrix.out_end(u); e++) {
+                const int v = matrix.target(e);
+                if (!S::accumulate_atomic(y.dense[v], S::multiply(value, matrix.weight(e)))) continue;
+                if (std::atomic_ref<uint8_t>(changed_flags[v]).exchange(1, std::memory_order_relaxed) == 0) out.push_back(v);
+            }
+        }
+    }, threads);
+
+    collect(y, chunks);
+    for (int v : y.active) changed_flags[v] = 0;
+}
+
+template<typename S>
+typename S::Value SemiringEngine<S>::reduce_column(int v, const Vector& x) const {
+    if constexpr (S::KIND == SemiringKind::BOOLEAN) {
+        if (matrix.has_bitsets()) return matrix.in_row_intersects(v, x_bits.data()) ? 1 : 0;
+        for (int e = matrix.in_begin(v); e < matrix.in_end(v); e++) {
+            if (x.dense[matrix.source(e)]) return 1;
+        }
+        return 0;
+    } else if constexpr (S::KIND == SemiringKind::MIN_PLUS) {
+        return matrix.min_plus_in_row(v, x.dense.data());
+    } else if constexpr (S::KIND == SemiringKind::PLUS_TIMES || S::KIND == SemiringKind::PLUS_FIRST) {
+        return matrix.sum_in_row(v, x.dense.data(), S::KIND == SemiringKind::PLUS_TIMES);
+    } else {
+        Value total = S::zero();
+        for (int e = matrix.in_begin(v); e < matrix.in_end(v); e++) {
+            total = S::add(total, S::multiply(x.dense[matrix.source(e)], matrix.in_weight(e)));
+        }
+        return total;
+    }
+}
+
+template<typename S>
+void SemiringEngine<S>::pull(const Vector& x, Vector& y) {
+    const int n = matrix.get_number_of_vertices();
+    if constexpr (S::KIND == SemiringKind::BOOLEAN) {
+        if (matrix.has_bitsets()) {
+            x_bits.assign(matrix.get_words(), 0);
+            for (int u : x.active) {
+                if (x.dense[u]) x_bits[u >> 6] |= uint64_t(1) << (u & 63);
+            }
+        }
+    }
+
+    const int chunks = (n + CHUNK - 1) / CHUNK;
+    if (static_cast<int>(changed.size()) < chunks) changed.resize(chunks);
+    parallel_for(0, chunks, [&](int chunk) {
+        std::vector<int>& out = changed[chunk];
+        const int end = std::min(n, (chunk + 1) * CHUNK);
+        for (int v = chunk * CHUNK; v < end; v++) {
+            if (S::is_absorbing(y.dense[v])) continue;
+            const Value sum = S::add(y.dense[v], reduce_column(v, x));
+            if (sum == y.dense[v]) continue;
+            y.dense[v] = sum;
+            out.push_back(v);
+        }
+    }, threads);
+
+    collect(y, chunks);
+}
+
+//* y.active = changed entries of all chunks, in chunk order
+template<typename S>
+void SemiringEngine<S>::collect(Vector& y, int chunks) {
+    y.active.clear();
+    for (int chunk = 0; chunk < chunks; chunk++) {
+        y.active.insert(y.active.end(), changed[chunk].begin(), changed[chunk].end());
+        changed[chunk].clear();
+    }
+}
+
+/**
+ * @brief BFS as iterated boolean products: visited += frontier * A, the changed entries
+ * are the next frontier. Returns the number of edges from source (-1 if unreachable).
+ */
+std::vector<int> algebraic_bfs(const SemiringMatrix& matrix, const int source, const int threads = default_thread_count()) {
+    const int n = matrix.get_number_of_vertices();
+    std::vector<int> level(n, -1);
+    if (source < 0 || source >= n) return level;
+
+    SemiringEngine<BooleanSemiring> engine(matrix, threads);
+    SemiringVector<uint8_t> frontier = engine.make_vector();
+    SemiringVector<uint8_t> visited = engine.make_vector();
+    frontier.set(source, 1);
+    visited.dense[source] = 1;
+    level[source] = 0;
+
+    for (int depth = 1; !frontier.active.empty(); depth++) {
+        engine.multiply(frontier, visited);
+        frontier.clear(0);
+        for (int v : visited.active) {
+            level[v] = depth;
+            frontier.set(v, 1);
+        }
+    }
+    return level;
+}
+
+/**
+ * @brief Bellman-Ford as iterated min-plus products over the vertices whose distance changed,
+ * negative weights included. Returns LLONG_MAX for unreachable vertices; after n rounds with
+ * changes left (a negative cycle) it stops and the distances are not final.
+ */
+std::vector<long long> algebraic_shortest_paths(const SemiringMatrix& matrix, const int source, const int threads = default_thread_count()) {
+    const int n = matrix.get_number_of_vertices();
+    SemiringEngine<MinPlusSemiring> engine(matrix, threads);
+    SemiringVector<long long> distance = engine.make_vector();
+    if (source < 0 || source >= n) return distance.dense;
+
+    SemiringVector<long long> frontier = engine.make_vector();
+    frontier.set(source, 0);
+    distance.dense[source] = 0;
+
+    for (int round = 0; round < n && !frontier.active.empty(); round++) {
+        engine.multiply(frontier, distance);
+        frontier.clear(MinPlusSemiring::zero());
+        for (int v : distance.active) frontier.set(v, distance.dense[v]);
+    }
+    return distance.dense;
+}
+
+/**
+ * @brief PageRank by power iteration: every round is one plus-first pull of rank / out-degree.
+ * The rank of vertices without out-edges is spread evenly over all vertices.
+ */
+std::vector<double> pagerank(const SemiringMatrix& matrix, const double damping = 0.85, const int iterations = 20,
+        const int threads = default_thread_count()) {
+    const int n = matrix.get_number_of_vertices();
+    if (n == 0) return {};
+
+    SemiringEngine<PlusFirstSemiring> engine(matrix, threads);
+    std::vector<double> rank(n, 1.0 / n);
+    SemiringVector<double> share = engine.make_vector();
+    SemiringVector<double> sum = engine.make_vector();
+
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        double dangling = 0.0;
+        for (int u = 0; u < n; u++) {
+            const int degree = matrix.out_degree(u);
+            share.dense[u] = degree ? rank[u] / degree : 0.0;
+            if (!degree) dangling += rank[u];
+        }
+        std::fill(sum.dense.begin(), sum.dense.end(), 0.0);
+        engine.pull(share, sum);
+
+        const double base = (1.0 - damping) / n + damping * dangling / n;
+        for (int v = 0; v < n; v++) rank[v] = base + damping * sum.dense[v];
+    }
+    return rank;
+}
+#endif
@@ -0,0 +1,252 @@
+#ifndef SHORTEST_CYCLE_H
+#define SHORTEST_CYCLE_H
+
+#include "Graph.h"
+#include "GraphConcept.h"
+#include "StronglyConnected.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Shortest cycles (in edges) of a directed graph: the girth and the shortest cycle
+ * through every vertex, by BFS from a vertex back to itself.
+ * @note A cycle never leaves a strongly connected component, so searches stay inside the
+ * @note component of the source, and vertices of single-vertex components without a self-loop
+ * @note are not searched at all.
+ * @note The girth uses two bounds: a search from v enters only vertices with ids > v (every
+ * @note cycle is found from its smallest vertex), and it stops at the depth of the best cycle
+ * @note found so far by any thread.
+ * @note Searches run in parallel, each worker with its own buffers, reset per search in O(1).
+ * @note find_cycles lists cycles by DFS in exponential time at worst; here each search is one
+ * @note BFS, O(n * (n + m)) in total and usually much less.
+ */
+template<OutNeighborGraph G>
+class ShortestCycleFinder {
+    public:
+        static constexpr int NO_CYCLE = -1;
+
+        ShortestCycleFinder(const G& graph, int threads = default_thread_count());
+
+        //! długość najkrótszego cyklu grafu, NO_CYCLE gdy graf jest acykliczny
+        int girth();
+        //! wierzchołki jednego najkrótszego cyklu w kolejności krawędzi, pusty gdy go nie ma
+        std::vector<int> shortest_cycle();
+
+        //! długość najkrótszego cyklu przez v, NO_CYCLE gdy v nie leży na cyklu
+        int cycle_length(int v) { return search(v, 0, INT_MAX, scratch);}
+        //! wierzchołki najkrótszego cyklu przez v, zaczynając od v
+        std::vector<int> cycle_through(int v);
+        //! cycle_length dla wszystkich wierzchołków, liczone równolegle
+        std::vector<int> cycle_lengths();
+
+        const SccResult& get_components() const { return scc;}
+
+    private:
+        //* buffers of one BFS
+        struct Scratch {
+            std::vector<uint32_t> seen;   // numer przeszukiwania, w którym wierzchołek osiągnięto
+            std::vector<int> parent;
+            std::vector<int> queue;
+            uint32_t epoch = 0;
+            int last = -1;                // wierzchołek, którego krawędź zamknęła cykl
+        };
+
+        const G& graph;
+        int threads;
+        SccResult scc;
+        std::vector<uint8_t> cyclic;      // czy komponent zawiera cykl
+        Scratch scratch;
+        int girth_source = -1;            // źródło najkrótszego cyklu z ostatniego girth()
+
+        int search(int source, int minimum, int bound, Scratch& buffers) const;
+        std::vector<int> trace(int source, const Scratch& buffers) const;
+        std::vector<Scratch> make_workers() const;
+};
+
+template<OutNeighborGraph G>
+ShortestCycleFinder<G>::ShortestCycleFinder(const G& graph, int threads)
+    : graph(graph), threads(threads < 1 ? 1 : threads) {
+    scc = strongly_connected_components(graph);
+    const int n = graph.get_number_of_vertices();
+    std::vector<int> size(scc.count, 0);
+    for (int v = 0; v < n; v++) size[scc.component[v]]++;
+    cyclic.assign(scc.count, 0);
+    for (int v = 0; v < n; v++) {
+        const int c = scc.component[v];
+        if (size[c] > 1) {
+            cyclic[c] = 1;
+            continue;
+        }
+        graph.for_each_out_neighbor(v, [&](int v_incoming, int) {
+            if (v_incoming == v) cyclic[c] = 1;
+        });
+    }
+}
+
+/**
+ * @brief BFS from source over its component, restricted to vertices >= minimum (source aside),
+ * until an edge comes back to source. Cycles of length >= bound are not looked for.
+ * @note On success buffers.parent and buffers.last describe the cycle.
+ */
+template<OutNeighborGraph G>
+int ShortestCycleFinder<G>::search(int source, int minimum, int bound, Scratch& buffers) const {
+    const int component = scc.component[source];
+    if (!cyclic[component]) return NO_CYCLE;
+
+    const size_t n = graph.get_number_of_vertices();
+    if (buffers.seen.size() != n) {
+        buffers.seen.assign(n, 0);
+        buffers.parent.assign(n, -1);
+        buffers.epoch = 0;
+    }
+    if (++buffers.epoch == 0) {
+        std::fill(buffers.seen.begin(), buffers.seen.end(), 0);
+        buffers.epoch = 1;
+    }
+    const uint32_t epoch = buffers.epoch;
+
+    buffers.queue.clear();
+    buffers.queue.push_back(source);
+    buffers.seen[source] = epoch;
+    buffers.parent[source] = -1;
+
+    size_t level_end = 1;
+    int depth = 0;
+    for (size_t head = 0; head < buffers.queue.size(); head++) {
+        if (head == level_end) {
+            level_end = buffers.queue.size();
+            depth++;
+        }
+        //* every cycle found from here on has at least depth + 1 edges
+        if (depth + 1 >= bound) return NO_CYCLE;
+
+        const int v = buffers.queue[head];
+        bool closed = false;
+        graph.for_each_out_neighbor(v, [&](int v_incoming, int) {
+            if (closed) return;
+            if (v_incoming == source) {
+                closed = true;
+                return;
+            }
+            if (v_incoming < minimum || buffers.seen[v_incoming] == epoch) return;
+            if (scc.component[v_incoming] != component) return;
+            buffers.seen[v_incoming] = epoch;
+            buffers.parent[v_incoming] = v;
+            buffers.queue.push_back(v_incoming);
+        });
+        if (closed) {
+            buffers.last = v;
+            return depth + 1;
+        }
+    }
+    return NO_CYCLE;
+}
+
+template<OutNeighborGraph G>
+std::vector<int> ShortestCycleFinder<G>::trace(int source, const Scratch& buffers) const {
+    std::vector<int> cycle;
+    for (int v = buffers.last; v != source; v = buffers.parent[v]) cycle.push_back(v);
+    cycle.push_back(source);
+    std::reverse(cycle.begin(), cycle.end());
+    return cycle;
+}
+
+template<OutNeighborGraph G>
+std::vector<typename ShortestCycleFinder<G>::Scratch> ShortestCycleFinder<G>::make_workers() const {
+    const int n = graph.get_number_of_vertices();
+    return std::vector<Scratch>(std::max(1, std::min(threads, n)));
+}
+
+template<OutNeighborGraph G>
+int ShortestCycleFinder<G>::girth() {
+    const int n = graph.get_number_of_vertices();
+    //* (length << 32) | source of the best cycle so far, so that one atomic min keeps both
+    std::atomic<uint64_t> best(UINT64_MAX);
+    std::atomic<int> next(0);
+    std::vector<Scratch> workers = make_workers();
+
+    parallel_for(0, static_cast<int>(workers.size()), [&](int worker) {
+        Scratch& buffers = workers[worker];
+        for (int v = next.fetch_add(1, std::memory_order_relaxed); v < n; v = next.fetch_add(1, std::memory_order_relaxed)) {
+            const uint64_t current = best.load(std::memory_order_relaxed);
+            const int bound = (current == UINT64_MAX) ? INT_MAX : static_cast<int>(current >> 32);
+            if (bound == 1) return;  // pętla własna, krótszego cyklu nie ma
+            const int length = search(v, v + 1, bound, buffers);
+            if (length == NO_CYCLE) continue;
+
+            const uint64_t found = (static_cast<uint64_t>(length) << 32) | static_cast<uint32_t>(v);
+            uint64_t expected = best.load(std::memory_order_relaxed);
+            while (found < expected && !best.compare_exchange_weak(expected, found, std::memory_order_relaxed)) {}
+        }
+    }, static_cast<int>(workers.size()));
+
+    const uint64_t result = best.load();
+    if (result == UINT64_MAX) return NO_CYCLE;
+    girth_source = static_cast<int>(result & 0xffffffffu);
+    return static_cast<int>(result >> 32);
+}
+
+template<OutNeighborGraph G>
+std::vector<int> ShortestCycleFinder<G>::shortest_cycle() {
+    if (girth() == NO_CYCLE) return {};
+    const int source = girth_source;
+    search(source, source + 1, INT_MAX, scratch);
+    return trace(source, scratch);
+}
+
+template<OutNeighborGraph G>
+std::vector<int> ShortestCycleFinder<G>::cycle_through(int v) {
+    if (search(v, 0, INT_MAX, scratch) == NO_CYCLE) return {};
+    return trace(v, scratch);
+}
+
+template<OutNeighborGraph G>
+std::vector<int> ShortestCycleFinder<G>::cycle_lengths() {
+    const int n = graph.get_number_of_vertices();
+    std::vector<int> lengths(n, NO_CYCLE);
+    std::atomic<int> next(0);
+    std::vector<Scratch> workers = make_workers();
+
+    parallel_for(0, static_cast<int>(workers.size()), [&](int worker) {
+        Scratch& buffers = workers[worker];
+        for (int v = next.fetch_add(1, std::memory_order_relaxed); v < n; v = next.fetch_add(1, std::memory_order_relaxed)) {
+            lengths[v] = search(v, 0, INT_MAX, buffers);
+        }
+    }, static_cast<int>(workers.size()));
+    return lengths;
+}
+
+//! długość najkrótszego cyklu grafu, -1 gdy graf jest acykliczny
+template<OutNeighborGraph G>
+int girth(const G& graph) {
+    return ShortestCycleFinder<G>(graph).girth();
+}
+
+int girth(const Graph& graph) {
+    return girth(VirtualGraph(graph));
+}
+
+//! wierzchołki jednego najkrótszego cyklu grafu, pusty gdy graf jest acykliczny
+template<OutNeighborGraph G>
+std::vector<int> shortest_cycle(const G& graph) {
+    return ShortestCycleFinder<G>(graph).shortest_cycle();
+}
+
+std::vector<int> shortest_cycle(const Graph& graph) {
+    return shortest_cycle(VirtualGraph(graph));
+}
+
+//! długości najkrótszych cykli przez każdy wierzchołek, -1 dla wierzchołków spoza cykli
+template<OutNeighborGraph G>
+std::vector<int> shortest_cycle_lengths(const G& graph) {
+    return ShortestCycleFinder<G>(graph).cycle_lengths();
+}
+
+std::vector<int> shortest_cycle_lengths(const Graph& graph) {
+    return shortest_cycle_lengths(VirtualGraph(graph));
+}
+#endif
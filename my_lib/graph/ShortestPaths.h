@@ -0,0 +1,240 @@
+#ifndef SHORTEST_PATHS_H
+#define SHORTEST_PATHS_H
+
+#include "Graph.h"
+#include "GraphConcept.h"
+#include "Parallel.h"
+#include "RadixHeap.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <vector>
+
+/**
+ * @brief Single-source shortest paths filled by dijkstra() and delta_stepping(); the same object
+ * can be passed to many queries, the arrays are reused.
+ * @note Edges with a negative weight cannot be handled by either algorithm, they are skipped
+ * @note and counted in ignored_edges.
+ */
+struct ShortestPathTree {
+    using Distance = long long;
+    static constexpr Distance UNREACHABLE = LLONG_MAX;
+
+    int source = -1;
+    std::vector<Distance> distance;     //* distance[v] - length of the shortest path, UNREACHABLE if none
+    std::vector<int> predecessor;       //* previous vertex on that path, -1 for the source and unreachable vertices
+    long long ignored_edges = 0;        //* relaxed edges with a negative weight
+
+    bool reachable(int v) const { return distance[v] != UNREACHABLE;}
+
+    //! zwraca wierzchołki ścieżki od source do v (z oboma końcami), pustą gdy v jest nieosiągalny
+    std::vector<int> path_to(int v) const;
+
+    void reset(int n, int from) {
+        source = from;
+        distance.assign(n, UNREACHABLE);
+        predecessor.assign(n, -1);
+        ignored_edges = 0;
+    }
+};
+
+std::vector<int> ShortestPathTree::path_to(int v) const {
+    std::vector<int> path;
+    if (!reachable(v)) return path;
+    for (; v != -1; v = predecessor[v]) path.push_back(v);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+/**
+ * @brief Dijkstra's algorithm with a RadixHeap, O(m + n log C) for the largest distance C.
+ * @note With target >= 0 the search stops as soon as the target is settled (a point-to-point
+ * @note query), distances of vertices not settled by then are only upper bounds.
+ */
+template<OutNeighborGraph G>
+void dijkstra(const G& graph, const int source, ShortestPathTree& result, const int target = -1) {
+    using Distance = ShortestPathTree::Distance;
+    const int n = graph.get_number_of_vertices();
+    result.reset(n, source);
+    if (source < 0 || source >= n) return;
+
+    RadixHeap<int> heap;
+    result.distance[source] = 0;
+    heap.push(0, source);
+
+    while (!heap.empty()) {
+        const auto [key, v] = heap.pop();
+        const Distance d = static_cast<Distance>(key);
+        if (d != result.distance[v]) continue; // nieaktualny wpis, v ma już mniejszą odległość
+        if (v == target) break;
+
+        graph.for_each_out_neighbor(v, [&](int v_incoming, int weight) {
+            if (weight < 0) {
+                result.ignored_edges++;
+                return;
+            }
+            const Distance candidate = d + weight;
+            if (candidate >= result.distance[v_incoming]) return;
+            result.distance[v_incoming] = candidate;
+            result.predecessor[v_incoming] = v;
+            heap.push(static_cast<uint64_t>(candidate), v_incoming);
+        });
+    }
+}
+
+void dijkstra(const Graph& graph, const int source, ShortestPathTree& result, const int target = -1) {
+    dijkstra(VirtualGraph(graph), source, result, target);
+}
+
+/**
+ * @brief Parallel delta-stepping: vertices wait in buckets of width delta, and all vertices of the
+ * smallest non-empty bucket relax their edges at the same time (distances are lowered with
+ * a compare-and-swap), until no bucket is left.
+ * @note A relaxed distance is at most max weight above the current bucket, so the buckets
+ * @note form a ring of max weight / delta + 2 slots; delta is raised when needed, so that
+ * @note the ring has at most MAX_BUCKETS + 2 of them.
+ * @note delta = 0 picks max weight / average degree: large enough to give every round
+ * @note plenty of vertices, small enough to keep re-relaxations rare.
+ * @note Predecessors are set afterwards by a parallel BFS over the tight edges
+ * @note (distance[u] + w == distance[v]), so they always form a tree, also with zero weights.
+ * @note The graph is finalized (finalize_graph) on the calling thread before any concurrent read.
+ */
+template<OutNeighborGraph G>
+void delta_stepping(const G& graph, const int source, ShortestPathTree& result,
+        ShortestPathTree::Distance delta = 0, const int threads = default_thread_count()) {
+    using Distance = ShortestPathTree::Distance;
+    constexpr int CHUNK = 256;
+    constexpr int UNSET = -2;
+    constexpr Distance MAX_BUCKETS = 1 << 16;
+
+    const int n = graph.get_number_of_vertices();
+    result.reset(n, source);
+    if (source < 0 || source >= n) return;
+
+    //* (vertex, bucket) pairs found by one chunk of a round
+    struct Found {
+        std::vector<std::pair<int, Distance>> vertices;
+        long long ignored = 0;
+    };
+    std::vector<Found> found;
+
+    //* relaxes the edges of a chunk of frontier vertices, skipping those already settled in an earlier bucket
+    auto relax_all = [&](const std::vector<int>& frontier, Distance bucket_start, int count) {
+        const int chunks = (count + CHUNK - 1) / CHUNK;
+        if (static_cast<int>(found.size()) < chunks) found.resize(chunks);
+        parallel_for(0, chunks, [&](int chunk) {
+            Found& out = found[chunk];
+            const int end = std::min(count, (chunk + 1) * CHUNK);
+            for (int i = chunk * CHUNK; i < end; i++) {
+                const int v = frontier[i];
+                const Distance d = std::atomic_ref<Distance>(result.distance[v]).load(std::memory_order_relaxed);
+                if (d < bucket_start) continue;
+
+                graph.for_each_out_neighbor(v, [&](int v_incoming, int weight) {
+                    if (weight < 0) {
+                        out.ignored++;
+                        return;
+                    }
+                    const Distance candidate = d + weight;
+                    std::atomic_ref<Distance> slot(result.distance[v_incoming]);
+                    Distance current = slot.load(std::memory_order_relaxed);
+                    while (candidate < current) {
+                        if (slot.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {
+                            out.vertices.push_back({v_incoming, candidate / delta});
+                            break;
+                        }
+                    }
+                });
+            }
+        }, threads);
+        return chunks;
+    };
+
+    //* pending edges are merged on this thread, then the largest weight is found in parallel
+    finalize_graph(graph);
+    result.distance[source] = 0;
+    Distance max_weight = 1;
+
+    const int vertex_chunks = (n + CHUNK - 1) / CHUNK;
+    std::vector<Distance> chunk_max(vertex_chunks, 1);
+    parallel_for(0, vertex_chunks, [&](int chunk) {
+        const int end = std::min(n, (chunk + 1) * CHUNK);
+        for (int v = chunk * CHUNK; v < end; v++) {
+            graph.for_each_out_neighbor(v, [&](int, int weight) { chunk_max[chunk] = std::max<Distance>(chunk_max[chunk], weight);});
+        }
+    }, threads);
+    for (Distance m : chunk_max) max_weight = std::max(max_weight, m);
+
+    if (delta <= 0) {
+        const Distance average_degree = std::max<Distance>(1, graph.get_number_of_edges() / std::max(1, n));
+        delta = std::max<Distance>(1, max_weight / average_degree);
+    }
+    //* a tiny delta with huge weights would allocate billions of buckets before relaxing anything
+    delta = std::max(delta, (max_weight + MAX_BUCKETS - 1) / MAX_BUCKETS);
+
+    const Distance ring_size = max_weight / delta + 2;
+    std::vector<std::vector<int>> ring(ring_size);
+    std::vector<int> frontier(1, source);
+    size_t waiting = 0;
+    Distance bucket = 0;
+
+    for (;;) {
+        const int chunks = relax_all(frontier, bucket * delta, static_cast<int>(frontier.size()));
+        for (int chunk = 0; chunk < chunks; chunk++) {
+            for (const auto& [v, b] : found[chunk].vertices) ring[b % ring_size].push_back(v);
+            waiting += found[chunk].vertices.size();
+            result.ignored_edges += found[chunk].ignored;
+            found[chunk].vertices.clear();
+            found[chunk].ignored = 0;
+        }
+        if (waiting == 0) break;
+
+        //* the same bucket again when light edges refilled it, otherwise the next non-empty one
+        while (ring[bucket % ring_size].empty()) bucket++;
+        frontier.clear();
+        frontier.swap(ring[bucket % ring_size]);
+        waiting -= frontier.size();
+    }
+
+    //* predecessors: level by level from the source along tight edges, the first writer wins
+    std::vector<int>& predecessor = result.predecessor;
+    for (int v = 0; v < n; v++) {
+        if (result.distance[v] != ShortestPathTree::UNREACHABLE) predecessor[v] = UNSET;
+    }
+    predecessor[source] = -1;
+
+    std::vector<std::vector<int>> next_level;
+    frontier.assign(1, source);
+    while (!frontier.empty()) {
+        const int count = static_cast<int>(frontier.size());
+        const int chunks = (count + CHUNK - 1) / CHUNK;
+        next_level.resize(chunks);
+        parallel_for(0, chunks, [&](int chunk) {
+            std::vector<int>& out = next_level[chunk];
+            const int end = std::min(count, (chunk + 1) * CHUNK);
+            for (int i = chunk * CHUNK; i < end; i++) {
+                const int v = frontier[i];
+                const Distance d = result.distance[v];
+                graph.for_each_out_neighbor(v, [&](int v_incoming, int weight) {
+                    if (weight < 0 || d + weight != result.distance[v_incoming]) return;
+                    int expected = UNSET;
+                    if (std::atomic_ref<int>(predecessor[v_incoming]).compare_exchange_strong(expected, v, std::memory_order_relaxed)) {
+                        out.push_back(v_incoming);
+                    }
+                });
+            }
+        }, threads);
+
+        frontier.clear();
+        for (int chunk = 0; chunk < chunks; chunk++) {
+            frontier.insert(frontier.end(), next_level[chunk].begin(), next_level[chunk].end());
+            next_level[chunk].clear();
+        }
+    }
+}
+
+void delta_stepping(const Graph& graph, const int source, ShortestPathTree& result,
+        ShortestPathTree::Distance delta = 0, const int threads = default_thread_count()) {
+    delta_stepping(VirtualGraph(graph), source, result, delta, threads);
+}
+#endif
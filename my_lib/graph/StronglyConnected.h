@@ -0,0 +1,134 @@
+#ifndef STRONGLY_CONNECTED_H
+#define STRONGLY_CONNECTED_H
+
+#include "Graph.h"
+#include "GraphConcept.h"
+#include <vector>
+
+struct SccResult {
+    int count = 0;              //* number of strongly connected components
+    std::vector<int> component; //* component[v] - id of the component containing v
+};
+
+/**
+ * @brief Iterative Tarjan algorithm (no recursion, so deep graphs do not overflow the stack).
+ * @note Components are numbered in the order Tarjan closes them, which is a reverse
+ * @note topological order of the condensation: an edge between two different
+ * @note components always goes from a higher id to a lower one.
+ * @note Out-neighbours of the vertices on the DFS path are kept on one shared stack,
+ * @note so the DFS can be paused in the middle of a row without a copy of the graph.
+ */
+template<OutNeighborGraph G>
+SccResult strongly_connected_components(const G& graph) {
+    const int n = graph.get_number_of_vertices();
+
+    SccResult result;
+    result.component.assign(n, -1);
+    std::vector<int> order(n, -1);  // numer odwiedzenia wierzchołka
+    std::vector<int> low(n, 0);
+    std::vector<int> next_edge(n, 0);  // pozycja następnego sąsiada w neighbours
+    std::vector<int> row_end(n, 0);
+    std::vector<int> neighbours;
+    std::vector<int> call_stack;
+    std::vector<int> scc_stack;
+    int counter = 0;
+
+    auto enter = [&](int v) {
+        order[v] = low[v] = counter++;
+        next_edge[v] = static_cast<int>(neighbours.size());
+        graph.for_each_out_neighbor(v, [&neighbours](int v_incoming, int) {
+            neighbours.push_back(v_incoming);
+        });
+        row_end[v] = static_cast<int>(neighbours.size());
+        scc_stack.push_back(v);
+        call_stack.push_back(v);
+    };
+
+    for (int root = 0; root < n; root++) {
+        if (order[root] != -1) continue;
+        enter(root);
+
+        while (!call_stack.empty()) {
+            const int v = call_stack.back();
+
+            if (next_edge[v] < row_end[v]) {
+                const int mate = neighbours[next_edge[v]++];
+                if (order[mate] == -1) {
+                    enter(mate);
+                } else if (result.component[mate] == -1 && order[mate] < low[v]) {
+                    low[v] = order[mate];
+                }
+                continue;
+            }
+
+            call_stack.pop_back();
+            //* the row of v starts right behind the row of its parent
+            neighbours.resize(call_stack.empty() ? 0 : row_end[call_stack.back()]);
+            if (!call_stack.empty() && low[v] < low[call_stack.back()]) {
+                low[call_stack.back()] = low[v];
+            }
+
+            if (low[v] == order[v]) {
+                int w;
+                do {
+                    w = scc_stack.back();
+                    scc_stack.pop_back();
+                    result.component[w] = result.count;
+                } while (w != v);
+                result.count++;
+            }
+        }
+    }
+
+    return result;
+}
+
+SccResult strongly_connected_components(const Graph& graph) {
+    return strongly_connected_components(VirtualGraph(graph));
+}
+
+/**
+ * @brief Keeps the component id only for vertices that lie on a cycle, that is in
+ * components with more than one vertex or with a self-loop; other vertices get -1.
+ */
+template<OutNeighborGraph G>
+std::vector<int> cyclic_component_labels(const G& graph, const SccResult& scc) {
+    std::vector<int> size(scc.count, 0);
+    std::vector<bool> cyclic(scc.count, false);
+    for (int c : scc.component) size[c]++;
+
+    for (int v = 0; v < graph.get_number_of_vertices(); v++) {
+        if (size[scc.component[v]] > 1) {
+            cyclic[scc.component[v]] = true;
+            continue;
+        }
+        graph.for_each_out_neighbor(v, [&](int v_incoming, int) {
+            if (v_incoming == v) cyclic[scc.component[v]] = true;
+        });
+    }
+
+    std::vector<int> labels(scc.component.size(), -1);
+    for (size_t v = 0; v < labels.size(); v++) {
+        if (cyclic[scc.component[v]]) labels[v] = scc.component[v];
+    }
+    return labels;
+}
+
+std::vector<int> cyclic_component_labels(const Graph& graph, const SccResult& scc) {
+    return cyclic_component_labels(VirtualGraph(graph), scc);
+}
+
+/**
+ * @brief Labels every vertex with the index of the first cycle (as returned by
+ * GraphAsMatrix::find_cycles) that contains it, -1 for vertices outside of cycles.
+ */
+std::vector<int> cycle_labels(const std::vector<std::vector<int>>& cycles, const int number_of_vertices) {
+    std::vector<int> labels(number_of_vertices, -1);
+    for (size_t i = 0; i < cycles.size(); i++) {
+        for (int v : cycles[i]) {
+            if (v >= 0 && v < number_of_vertices && labels[v] == -1) labels[v] = static_cast<int>(i);
+        }
+    }
+    return labels;
+}
+#endif
@@ -0,0 +1,423 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//! liczba wątków sprzętowych, co najmniej 1
+int hardware_thread_count() {
+    const unsigned count = std::thread::hardware_concurrency();
+    return count ? static_cast<int>(count) : 1;
+}
+
+class TaskGroup;
+
+//* one queued call: run(task, call) calls it when call is set, and frees it either way
+struct Task {
+    void (*run)(Task *task, bool call) = nullptr;
+    TaskGroup *group = nullptr;
+};
+
+/**
+ * @brief Chase-Lev work-stealing deque (in the C11 form of Le, Pop, Cohen and Zappa Nardelli):
+ * the owning worker pushes and pops at the bottom, any other thread steals from the top.
+ * @note The ring doubles when full. Old rings are kept until the deque is destroyed, since
+ * @note a thief may still be reading one.
+ */
+class WorkDeque {
+    public:
+        WorkDeque() {
+            rings.emplace_back(new Ring(INITIAL_CAPACITY));
+            ring.store(rings.back().get(), std::memory_order_relaxed);
+        }
+
+        //! tylko właściciel
+        void push(Task *task);
+        //! tylko właściciel, nullptr gdy kolejka jest pusta
+        Task* pop();
+        //! dowolny wątek, nullptr gdy kolejka jest pusta albo inny wątek był szybszy
+        Task* steal();
+
+        bool empty() const { return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);}
+
+    private:
+        static constexpr int64_t INITIAL_CAPACITY = 64;
+
+        struct Ring {
+            int64_t mask;
+            std::unique_ptr<std::atomic<Task*>[]> slots;
+
+            explicit Ring(int64_t capacity) : mask(capacity - 1), slots(new std::atomic<Task*>[capacity]) {}
+            int64_t capacity() const { return mask + 1;}
+            Task* get(int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed);}
+            void put(int64_t i, Task *task) { slots[i & mask].store(task, std::memory_order_relaxed);}
+        };
+
+        alignas(64) std::atomic<int64_t> top{0};
+        alignas(64) std::atomic<int64_t> bottom{0};
+        std::atomic<Ring*> ring{nullptr};
+        std::vector<std::unique_ptr<Ring>> rings;   // wszystkie pierścienie, ostatni jest bieżący
+};
+
+void WorkDeque::push(Task *task) {
+    const int64_t b = bottom.load(std::memory_order_relaxed);
+    const int64_t t = top.load(std::memory_order_acquire);
+    Ring *current = ring.load(std::memory_order_relaxed);
+    if (b - t > current->capacity() - 1) {
+        Ring *grown = new Ring(2 * current->capacity());
+        for (int64_t i = t; i < b; i++) grown->put(i, current->get(i));
+        rings.emplace_back(grown);
+        ring.store(grown, std::memory_order_release);
+        current = grown;
+    }
+    current->put(b, task);
+    bottom.store(b + 1, std::memory_order_release);
+}
+
+Task* WorkDeque::pop() {
+    const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Ring *current = ring.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Task *task = current->get(b);
+    if (t == b) {
+        //* the last task: race the thieves for it
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) task = nullptr;
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+Task* WorkDeque::steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) return nullptr;
+
+    Task *task = ring.load(std::memory_order_acquire)->get(t);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+    return task;
+}
+
+/**
+ * @brief Work-stealing thread pool shared by the graph library. A pool of size threads runs
+ * threads - 1 workers; the thread waiting for a TaskGroup is the last one, it runs tasks too.
+ * @note Every worker owns a WorkDeque: tasks spawned by a worker go to the bottom of its deque
+ * @note and it takes them back from there (newest first, the data is still in cache), while
+ * @note idle workers steal the oldest ones from random victims. Tasks from threads outside the
+ * @note pool go to a shared queue. A worker that finds nothing spins briefly, then sleeps until
+ * @note the next task is pushed.
+ * @note global() is the pool every algorithm uses; configure() sets its size, e.g. to leave
+ * @note a core for rendering. It may only be called while the pool is idle.
+ */
+class ThreadPool {
+    public:
+        explicit ThreadPool(int threads = hardware_thread_count());
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        //! liczba wątków wykonujących zadania, razem z czekającym
+        int get_concurrency() const { return static_cast<int>(workers.size()) + 1;}
+
+        static ThreadPool& global() {
+            std::lock_guard<std::mutex> lock(global_mutex());
+            std::unique_ptr<ThreadPool>& pool = instance();
+            if (!pool) pool = std::make_unique<ThreadPool>(configured_size());
+            return *pool;
+        }
+
+        //! rozmiar puli globalnej (co najmniej 1); istniejąca pula jest zamykana i powstaje od nowa
+        static void configure(int threads) {
+            std::lock_guard<std::mutex> lock(global_mutex());
+            configured_size() = std::max(1, threads);
+            instance().reset();
+        }
+
+        static int get_configured_size() {
+            std::lock_guard<std::mutex> lock(global_mutex());
+            return configured_size();
+        }
+
+        /**
+         * @brief Calls function(i) for every i in [begin, end) as tasks of group, with at most
+         * threads of them running at once, and waits for the whole group.
+         * @note The grain adapts itself (lazy binary splitting): a thread takes indices one by one
+         * @note and splits the upper half of what it has left off as a new task only while its own
+         * @note deque is empty, so a range is cut into as many pieces as there are idle threads.
+         * @note After group.cancel() no new index is started.
+         */
+        template<typename Function>
+        void parallel_for(TaskGroup& group, int begin, int end, Function& function, int threads);
+
+    private:
+        friend class TaskGroup;
+
+        static constexpr int SPINS = 64;   // próby znalezienia zadania przed zaśnięciem
+
+        struct Worker {
+            WorkDeque deque;
+            std::thread thread;
+        };
+
+        //* who runs on the current thread
+        struct Slot {
+            ThreadPool *pool = nullptr;
+            int index = -1;
+            uint64_t seed = 0x9e3779b97f4a7c15ull;
+        };
+
+        template<typename Function>
+        struct Range {
+            TaskGroup& group;
+            Function& function;
+            int limit;
+            std::atomic<int> pieces{1};
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<Task*> injected;            // zadania od wątków spoza puli
+        std::atomic<int> injected_count{0};
+        std::atomic<uint64_t> epoch{0};        // rośnie przy każdym nowym zadaniu
+        std::atomic<int> sleeping{0};
+        bool stopping = false;
+
+        static std::mutex& global_mutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+        static std::unique_ptr<ThreadPool>& instance() {
+            static std::unique_ptr<ThreadPool> pool;
+            return pool;
+        }
+        static int& configured_size() {
+            static int size = hardware_thread_count();
+            return size;
+        }
+        static Slot& here() {
+            thread_local Slot slot;
+            return slot;
+        }
+
+        //! numer workera tej puli na bieżącym wątku, -1 dla wątku spoza niej
+        int own_index() const { return here().pool == this ? here().index : -1;}
+        //! czy bieżący wątek nie ma zadań do oddania
+        bool is_hungry(int self) const {
+            return self >= 0 ? workers[self]->deque.empty() : injected_count.load(std::memory_order_relaxed) == 0;
+        }
+
+        void push(Task *task);
+        Task* find_task(int self);
+        void execute(Task *task);
+        void work(int index);
+
+        template<typename Function>
+        void run_range(Range<Function>& range, int begin, int end);
+};
+
+/**
+ * @brief Tasks that are waited for together. run() queues a call on the pool, wait() returns
+ * once all of them have finished and runs queued tasks itself in the meantime, so waiting
+ * inside a task does not block a worker. The destructor waits as well.
+ * @note cancel() drops the tasks that have not started yet; running ones can poll is_cancelled().
+ */
+class TaskGroup {
+    public:
+        explicit TaskGroup(ThreadPool& pool = ThreadPool::global()) : pool(pool) {}
+        ~TaskGroup() { wait();}
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        template<typename Function>
+        void run(Function&& function);
+        void wait();
+
+        void cancel() { cancelled.store(true, std::memory_order_relaxed);}
+        bool is_cancelled() const { return cancelled.load(std::memory_order_relaxed);}
+
+        ThreadPool& get_pool() const { return pool;}
+
+    private:
+        friend class ThreadPool;
+
+        template<typename Function>
+        struct FunctionTask : Task {
+            Function function;
+
+            explicit FunctionTask(Function&& f) : function(std::move(f)) {}
+            explicit FunctionTask(const Function& f) : function(f) {}
+
+            static void invoke(Task *task, bool call) {
+                FunctionTask *self = static_cast<FunctionTask*>(task);
+                if (call) self->function();
+                delete self;
+            }
+        };
+
+        ThreadPool& pool;
+        std::atomic<int> pending{0};
+        std::atomic<bool> cancelled{false};
+};
+
+ThreadPool::ThreadPool(int threads) {
+    const int count = std::max(1, threads) - 1;
+    workers.reserve(count);
+    for (int i = 0; i < count; i++) workers.push_back(std::make_unique<Worker>());
+    for (int i = 0; i < count; i++) workers[i]->thread = std::thread([this, i]() { work(i);});
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::unique_ptr<Worker>& worker : workers) worker->thread.join();
+}
+
+void ThreadPool::push(Task *task) {
+    const int self = own_index();
+    if (self >= 0) {
+        workers[self]->deque.push(task);
+    } else {
+        std::lock_guard<std::mutex> lock(mutex);
+        injected.push_back(task);
+        injected_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    //* a worker counts itself as sleeping before it rechecks the epoch, so one of the two sees the other
+    epoch.fetch_add(1, std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_seq_cst) > 0) {
+        { std::lock_guard<std::mutex> lock(mutex);}
+        wake.notify_one();
+    }
+}
+
+Task* ThreadPool::find_task(int self) {
+    if (self >= 0) {
+        if (Task *task = workers[self]->deque.pop()) return task;
+    }
+    if (injected_count.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!injected.empty()) {
+            Task *task = injected.front();
+            injected.pop_front();
+            injected_count.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+
+    const int count = static_cast<int>(workers.size());
+    if (count == 0) return nullptr;
+    uint64_t& seed = here().seed;
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    const int start = static_cast<int>(seed % count);
+    for (int k = 0; k < count; k++) {
+        const int victim = (start + k) % count;
+        if (victim == self) continue;
+        if (Task *task = workers[victim]->deque.steal()) return task;
+    }
+    return nullptr;
+}
+
+void ThreadPool::execute(Task *task) {
+    TaskGroup *group = task->group;
+    task->run(task, !group->is_cancelled());
+    //* after this the group may be gone
+    group->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void ThreadPool::work(int index) {
+    Slot& slot = here();
+    slot.pool = this;
+    slot.index = index;
+    slot.seed += static_cast<uint64_t>(index + 1) * 0xbf58476d1ce4e5b9ull;
+
+    while (true) {
+        const uint64_t seen = epoch.load(std::memory_order_seq_cst);
+        bool found = false;
+        for (int spin = 0; spin < SPINS && !found; spin++) {
+            if (Task *task = find_task(index)) {
+                execute(task);
+                found = true;
+            } else if (spin > SPINS / 2) {
+                std::this_thread::yield();
+            }
+        }
+        if (found) continue;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (stopping) return;
+        sleeping.fetch_add(1, std::memory_order_seq_cst);
+        wake.wait(lock, [&]() { return stopping || epoch.load(std::memory_order_seq_cst) != seen;});
+        sleeping.fetch_sub(1, std::memory_order_relaxed);
+        if (stopping) return;
+    }
+}
+
+template<typename Function>
+void ThreadPool::parallel_for(TaskGroup& group, int begin, int end, Function& function, int threads) {
+    Range<Function> range{group, function, std::clamp(threads, 1, get_concurrency())};
+    run_range(range, begin, end);
+    group.wait();
+}
+
+template<typename Function>
+void ThreadPool::run_range(Range<Function>& range, int begin, int end) {
+    const int self = own_index();
+    while (begin < end && !range.group.is_cancelled()) {
+        if (end - begin > 1 && range.pieces.load(std::memory_order_relaxed) < range.limit && is_hungry(self)) {
+            if (range.pieces.fetch_add(1, std::memory_order_relaxed) < range.limit) {
+                const int middle = begin + (end - begin) / 2;
+                range.group.run([this, &range, middle, end]() { run_range(range, middle, end);});
+                end = middle;
+                continue;
+            }
+            range.pieces.fetch_sub(1, std::memory_order_relaxed);
+        }
+        range.function(begin++);
+    }
+    range.pieces.fetch_sub(1, std::memory_order_relaxed);
+}
+
+template<typename Function>
+void TaskGroup::run(Function&& function) {
+    using Stored = std::decay_t<Function>;
+    FunctionTask<Stored> *task = new FunctionTask<Stored>(std::forward<Function>(function));
+    task->run = &FunctionTask<Stored>::invoke;
+    task->group = this;
+    pending.fetch_add(1, std::memory_order_relaxed);
+    pool.push(task);
+}
+
+void TaskGroup::wait() {
+    const int self = pool.own_index();
+    int idle = 0;
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (Task *task = pool.find_task(self)) {
+            pool.execute(task);
+            idle = 0;
+        } else if (++idle > ThreadPool::SPINS) {
+            std::this_thread::yield();
+        }
+    }
+}
+#endif
@@ -0,0 +1,115 @@
+#ifndef TILED_MATRIX_H
+#define TILED_MATRIX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief n x n matrix split into TILE x TILE square tiles kept in one contiguous pool;
+ * a tile is allocated on the first write into it, empty regions cost 4 bytes per tile.
+ * @note A row scan reads TILE consecutive cells per tile and skips missing tiles at once,
+ * @note a column scan stays inside one tile (TILE * TILE cells) per TILE rows, so both are cache friendly.
+ * @note Reading a missing tile gives T() (e.g. nullptr). References returned by at() are valid
+ * @note until the next tile is allocated.
+ */
+template<typename T, int TILE_BITS = 6>
+class TiledMatrix {
+    public:
+        static constexpr int TILE = 1 << TILE_BITS;
+        static constexpr int TILE_CELLS = TILE * TILE;
+
+        TiledMatrix(const int n = 0) { resize(n);}
+
+        //! zmienia rozmiar na n x n, usuwając całą zawartość
+        void resize(const int n) {
+            size = n;
+            tiles_per_side = (n + TILE - 1) / TILE;
+            directory.assign(static_cast<size_t>(tiles_per_side) * tiles_per_side, EMPTY);
+            pool.clear();
+        }
+
+        void clear() {
+            resize(0);
+            pool.shrink_to_fit();
+            directory.shrink_to_fit();
+        }
+
+        int get_size() const { return size;}
+        size_t allocated_tiles() const { return pool.size() / TILE_CELLS;}
+        size_t memory_usage() const { return directory.size() * sizeof(int32_t) + pool.size() * sizeof(T);}
+
+        T get(const int row, const int column) const {
+            const int32_t tile = directory[tile_of(row, column)];
+            return (tile == EMPTY) ? T() : pool[static_cast<size_t>(tile) * TILE_CELLS + cell_of(row, column)];
+        }
+
+        //! zwraca komórkę do zapisu, alokując jej kafelek przy pierwszym użyciu
+        T& at(const int row, const int column) {
+            int32_t& tile = directory[tile_of(row, column)];
+            if (tile == EMPTY) {
+                tile = static_cast<int32_t>(allocated_tiles());
+                pool.resize(pool.size() + TILE_CELLS, T());
+            }
+            return pool[static_cast<size_t>(tile) * TILE_CELLS + cell_of(row, column)];
+        }
+
+        //* calls function(column, value) for every non-empty cell of the row, by increasing column
+        template<typename Function>
+        void for_each_in_row(const int row, Function&& function) const {
+            const int32_t *tiles = directory.data() + static_cast<size_t>(row >> TILE_BITS) * tiles_per_side;
+            const int offset = (row & (TILE - 1)) * TILE;
+            for (int tile_column = 0; tile_column < tiles_per_side; tile_column++) {
+                if (tiles[tile_column] == EMPTY) continue;
+
+                const T *cells = pool.data() + static_cast<size_t>(tiles[tile_column]) * TILE_CELLS + offset;
+                const int first = tile_column * TILE;
+                const int count = (size - first < TILE) ? size - first : TILE;
+                for (int i = 0; i < count; i++) {
+                    if (cells[i] != T()) function(first + i, cells[i]);
+                }
+            }
+        }
+
+        //* calls function(row, value) for every non-empty cell of the column, by increasing row
+        template<typename Function>
+        void for_each_in_column(const int column, Function&& function) const {
+            const int offset = column & (TILE - 1);
+            for (int tile_row = 0; tile_row < tiles_per_side; tile_row++) {
+                const int32_t tile = directory[static_cast<size_t>(tile_row) * tiles_per_side + (column >> TILE_BITS)];
+                if (tile == EMPTY) continue;
+
+                const T *cells = pool.data() + static_cast<size_t>(tile) * TILE_CELLS + offset;
+                const int first = tile_row * TILE;
+                const int count = (size - first < TILE) ? size - first : TILE;
+                for (int i = 0; i < count; i++) {
+                    if (cells[i * TILE] != T()) function(first + i, cells[i * TILE]);
+                }
+            }
+        }
+
+        //* calls function(value) for every non-empty cell, tile by tile
+        template<typename Function>
+        void for_each_cell(Function&& function) const {
+            for (const T& cell : pool) {
+                if (cell != T()) function(cell);
+            }
+        }
+
+    private:
+        static constexpr int32_t EMPTY = -1;
+
+        int size = 0;
+        int tiles_per_side = 0;
+        std::vector<int32_t> directory; // numer kafelka w pool albo EMPTY
+        std::vector<T> pool;
+
+        size_t tile_of(const int row, const int column) const {
+            return static_cast<size_t>(row >> TILE_BITS) * tiles_per_side + (column >> TILE_BITS);
+        }
+
+        static int cell_of(const int row, const int column) {
+            return (row & (TILE - 1)) * TILE + (column & (TILE - 1));
+        }
+};
+#endif
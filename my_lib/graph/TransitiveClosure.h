@@ -0,0 +1,174 @@
+#ifndef TRANSITIVE_CLOSURE_H
+#define TRANSITIVE_CLOSURE_H
+
+#include "../../include/SDL2/SDL_cpuinfo.h"
+#include "Graph.h"
+#include "GraphConcept.h"
+#include "Condensation.h"
+#include "DynamicBitset.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TRANSITIVE_CLOSURE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TRANSITIVE_CLOSURE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define TRANSITIVE_CLOSURE_TARGET(isa)
+#endif
+
+/**
+ * @brief Reachability matrix of a graph: reaches(u, v) is one bit test.
+ * @note The graph is condensed first (strongly_connected_components), the bits are kept per
+ * @note component. Tarjan numbers components in reverse topological order, so component c
+ * @note reaches only components <= c and its row needs only c + 1 bits: the matrix is a
+ * @note triangle of C * C / 2 bits (about 600 MB for 100 000 components).
+ * @note Row c is the OR of the rows of its successors, taken by decreasing id, and a successor
+ * @note already present in the row is skipped - its whole row is already there.
+ * @note The condensation comes from Condensation; successors of a component lie on later levels
+ * @note of its topological order, so levels are computed from the last one, and the rows of one
+ * @note level do not depend on each other and are computed in parallel. The OR runs 256 bits at
+ * @note a time with AVX2.
+ */
+class TransitiveClosure {
+    public:
+        enum class Kernel { SCALAR, AVX2 };
+
+        TransitiveClosure(int threads = default_thread_count(), Kernel kernel = detect_kernel())
+            : threads(threads), kernel(kernel) {}
+
+        static Kernel detect_kernel();
+
+        template<OutNeighborGraph G>
+        void build(const G& graph);
+        void build(const Graph& graph) { build(VirtualGraph(graph));}
+
+        //! czy istnieje ścieżka z v_outgoing do v_incoming (każdy wierzchołek osiąga sam siebie)
+        bool reaches(int v_outgoing, int v_incoming) const {
+            const int from = dag.component_of(v_outgoing);
+            const int to = dag.component_of(v_incoming);
+            return to <= from && (row(from)[to >> 6] >> (to & 63)) & 1;
+        }
+
+        //! liczba wierzchołków osiągalnych z v, razem z nim
+        int count_reachable(int v) const;
+
+        const SccResult& get_components() const { return dag.get_components();}
+        const Condensation& get_condensation() const { return dag;}
+        size_t memory_usage() const {
+            return bits.capacity() * sizeof(uint64_t) + row_offsets.capacity() * sizeof(size_t) + dag.memory_usage();
+        }
+
+    private:
+        static constexpr int SERIAL_LEVEL = 64;  // mniejsze poziomy liczy jeden wątek
+
+        int threads;
+        Kernel kernel;
+        Condensation dag;
+        std::vector<size_t> row_offsets;   // początek wiersza komponentu w bits
+        std::vector<uint64_t> bits;
+
+        static size_t row_words(int component) { return static_cast<size_t>(component) / 64 + 1;}
+        const uint64_t* row(int component) const { return bits.data() + row_offsets[component];}
+
+        void or_row(uint64_t *target, const uint64_t *source, size_t words) const;
+#ifdef TRANSITIVE_CLOSURE_X86
+        static void or_row_avx2(uint64_t *target, const uint64_t *source, size_t words);
+#endif
+};
+
+TransitiveClosure::Kernel TransitiveClosure::detect_kernel() {
+#ifdef TRANSITIVE_CLOSURE_X86
+    if (SDL_HasAVX2()) return Kernel::AVX2;
+#endif
+    return Kernel::SCALAR;
+}
+
+#ifdef TRANSITIVE_CLOSURE_X86
+TRANSITIVE_CLOSURE_TARGET("avx2")
+void TransitiveClosure::or_row_avx2(uint64_t *target, const uint64_t *source, size_t words) {
+    size_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(target + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i), _mm256_or_si256(a, b));
+    }
+    for (; i < words; i++) target[i] |= source[i];
+}
+#endif
+
+void TransitiveClosure::or_row(uint64_t *target, const uint64_t *source, size_t words) const {
+#ifdef TRANSITIVE_CLOSURE_X86
+    if (kernel == Kernel::AVX2) {
+        or_row_avx2(target, source, words);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < words; i++) target[i] |= source[i];
+}
+
+template<OutNeighborGraph G>
+void TransitiveClosure::build(const G& graph) {
+    dag.build(graph, threads);
+    const int count = dag.get_number_of_vertices();
+    const std::vector<int>& offsets = dag.get_offsets();
+    const std::vector<int>& successors = dag.get_successors();
+
+    row_offsets.resize(count);
+    size_t total = 0;
+    for (int c = 0; c < count; c++) {
+        row_offsets[c] = total;
+        total += row_words(c);
+    }
+    bits.assign(total, 0);
+    bits.shrink_to_fit();
+
+    //* rows of the condensation are sorted by increasing id, so they are read backwards
+    auto compute_row = [&](int c) {
+        uint64_t *target = bits.data() + row_offsets[c];
+        target[c >> 6] |= uint64_t(1) << (c & 63);
+        for (int i = offsets[c + 1] - 1; i >= offsets[c]; i--) {
+            const int s = successors[i];
+            if ((target[s >> 6] >> (s & 63)) & 1) continue;
+            or_row(target, row(s), row_words(s));
+        }
+    };
+
+    const std::vector<int>& order = dag.get_order();
+    const std::vector<int>& level_offsets = dag.get_level_offsets();
+    for (int l = dag.get_number_of_levels() - 1; l >= 0; l--) {
+        const int first = level_offsets[l];
+        const int size = level_offsets[l + 1] - first;
+        parallel_for(0, size, [&](int i) { compute_row(order[first + i]);}, (size < SERIAL_LEVEL) ? 1 : threads);
+    }
+}
+
+int TransitiveClosure::count_reachable(int v) const {
+    const int from = dag.component_of(v);
+    int reachable = 0;
+    const uint64_t *r = row(from);
+    for (size_t w = 0; w < row_words(from); w++) {
+        for (uint64_t word = r[w]; word; word &= word - 1) {
+            reachable += dag.get_size(w * 64 + DynamicBitset::lowest_bit(word));
+        }
+    }
+    return reachable;
+}
+
+//! macierz osiągalności grafu, patrz TransitiveClosure
+template<OutNeighborGraph G>
+TransitiveClosure transitive_closure(const G& graph) {
+    TransitiveClosure closure;
+    closure.build(graph);
+    return closure;
+}
+
+TransitiveClosure transitive_closure(const Graph& graph) {
+    return transitive_closure(VirtualGraph(graph));
+}
+#endif
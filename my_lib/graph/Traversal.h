@@ -0,0 +1,264 @@
+#ifndef TRAVERSAL_H
+#define TRAVERSAL_H
+
+#include "Graph.h"
+#include "GraphConcept.h"
+#include "EdgeOverlay.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Breadth-first search from source, calls visit(v, distance) for every reached
+ * vertex in the order of visiting.
+ */
+template<OutNeighborGraph G, typename Visitor>
+void breadth_first(const G& graph, const int source, Visitor&& visit) {
+    const int n = graph.get_number_of_vertices();
+    if (source < 0 || source >= n) return;
+
+    std::vector<int> distance(n, -1);
+    std::vector<int> queue;
+    queue.reserve(n);
+    queue.push_back(source);
+    distance[source] = 0;
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        const int v = queue[head];
+        visit(v, distance[v]);
+        graph.for_each_out_neighbor(v, [&](int v_incoming, int) {
+            if (distance[v_incoming] != -1) return;
+            distance[v_incoming] = distance[v] + 1;
+            queue.push_back(v_incoming);
+        });
+    }
+}
+
+//! zwraca liczbę krawędzi na najkrótszej ścieżce z source do każdego wierzchołka, -1 gdy brak ścieżki
+template<OutNeighborGraph G>
+std::vector<int> bfs_distances(const G& graph, const int source) {
+    std::vector<int> distance(graph.get_number_of_vertices(), -1);
+    breadth_first(graph, source, [&distance](int v, int d) { distance[v] = d;});
+    return distance;
+}
+
+std::vector<int> bfs_distances(const Graph& graph, const int source) {
+    return bfs_distances(VirtualGraph(graph), source);
+}
+
+/**
+ * @brief The cycle search of GraphAsMatrix::find_cycles for any OutNeighborGraph: DFS from
+ * every vertex, an edge back to the current path closes a cycle and is not used again.
+ * @note Used edges are removed only from an OverlayGraph, the graph itself is not copied
+ * @note nor modified, so any number of finders can work on one graph at the same time.
+ */
+template<OutNeighborGraph G>
+class CycleFinder {
+    public:
+        CycleFinder(const G& graph) : graph(graph) {}
+
+        std::vector<std::vector<int>> find();
+
+    private:
+        OverlayGraph<G> graph;
+        std::vector<int> path;
+        std::vector<int> position;  // pozycja wierzchołka na ścieżce albo -1
+        std::vector<std::vector<int>> cycles;
+
+        void dfs(int v);
+};
+
+template<OutNeighborGraph G>
+std::vector<std::vector<int>> CycleFinder<G>::find() {
+    const int n = graph.get_number_of_vertices();
+    graph.restore_all();
+    path.clear();
+    position.assign(n, -1);
+    cycles.clear();
+
+    for (int v = 0; v < n; v++) dfs(v);
+    return cycles;
+}
+
+template<OutNeighborGraph G>
+void CycleFinder<G>::dfs(int v) {
+    position[v] = static_cast<int>(path.size());
+    path.push_back(v);
+
+    graph.for_each_out_neighbor(v, [this, v](int mate, int) {
+        if (position[mate] == -1) {
+            dfs(mate);
+        } else {
+            cycles.emplace_back(path.begin() + position[mate], path.end());
+            graph.remove_edge(v, mate);
+        }
+    });
+
+    path.pop_back();
+    position[v] = -1;
+}
+
+template<OutNeighborGraph G>
+std::vector<std::vector<int>> find_cycles(const G& graph) {
+    return CycleFinder<G>(graph).find();
+}
+
+std::vector<std::vector<int>> find_cycles(const Graph& graph) {
+    return find_cycles(VirtualGraph(graph));
+}
+
+/**
+ * @brief Point-to-point BFS from both ends: the forward search follows out-edges from the
+ * source, the backward one in-edges from the target, and each round expands a whole level
+ * of the smaller frontier. The first round in which the searches meet gives the distance.
+ * @note On graphs where the number of vertices within distance d grows fast, both searches
+ * @note stop at about half the distance and touch far fewer vertices than one BFS.
+ * @note All buffers belong to the object and are reset in O(touched), so a long series of
+ * @note queries costs nothing per query beyond the search itself; one object per thread.
+ */
+template<InNeighborGraph G>
+class BidirectionalBfs {
+    public:
+        BidirectionalBfs(const G& graph) : graph(graph) {}
+
+        //! zwraca liczbę krawędzi najkrótszej ścieżki z source do target, -1 gdy jej nie ma
+        int distance(int source, int target) { return search(source, target) ? best : -1;}
+        //! zwraca wierzchołki najkrótszej ścieżki (z oboma końcami), pustą gdy jej nie ma
+        std::vector<int> path(int source, int target);
+
+        //* vertices reached by the two searches of the last query
+        size_t get_touched() const { return touched.size();}
+
+    private:
+        //* per-vertex state of one direction
+        struct Side {
+            std::vector<uint32_t> seen;   // numer zapytania, w którym wierzchołek osiągnięto
+            std::vector<int> depth;
+            std::vector<int> parent;      // poprzednik w tym kierunku, -1 dla końca
+            std::vector<int> frontier;
+            std::vector<int> next;
+            int radius = 0;
+        };
+
+        const G& graph;
+        Side forward, backward;
+        std::vector<int> touched;
+        uint32_t epoch = 0;
+        int best = -1;
+        int meet_forward = -1;    // krawędź meet_forward -> meet_backward łączy oba drzewa
+        int meet_backward = -1;
+
+        bool search(int source, int target);
+        void start(Side& side, int vertex);
+        bool visit(Side& side, int vertex, int parent);
+        template<bool FORWARD>
+        void expand(Side& side, const Side& other);
+};
+
+template<InNeighborGraph G>
+void BidirectionalBfs<G>::start(Side& side, int vertex) {
+    const size_t n = graph.get_number_of_vertices();
+    if (side.seen.size() != n) {
+        side.seen.assign(n, 0);
+        side.depth.assign(n, 0);
+        side.parent.assign(n, -1);
+    }
+    side.frontier.assign(1, vertex);
+    side.radius = 0;
+    visit(side, vertex, -1);
+}
+
+//! zaznacza wierzchołek, zwraca false gdy ta strona już go osiągnęła
+template<InNeighborGraph G>
+bool BidirectionalBfs<G>::visit(Side& side, int vertex, int parent) {
+    if (side.seen[vertex] == epoch) return false;
+    side.seen[vertex] = epoch;
+    side.depth[vertex] = side.radius;
+    side.parent[vertex] = parent;
+    touched.push_back(vertex);
+    return true;
+}
+
+template<InNeighborGraph G>
+template<bool FORWARD>
+void BidirectionalBfs<G>::expand(Side& side, const Side& other) {
+    side.radius++;
+    side.next.clear();
+    for (int v : side.frontier) {
+        auto step = [&](int mate, int) {
+            if (other.seen[mate] == epoch) {
+                const int length = side.depth[v] + 1 + other.depth[mate];
+                if (best == -1 || length < best) {
+                    best = length;
+                    meet_forward = FORWARD ? v : mate;
+                    meet_backward = FORWARD ? mate : v;
+                }
+            }
+            if (visit(side, mate, v)) side.next.push_back(mate);
+        };
+        if constexpr (FORWARD) {
+            graph.for_each_out_neighbor(v, step);
+        } else {
+            graph.for_each_in_neighbor(v, step);
+        }
+    }
+    side.frontier.swap(side.next);
+}
+
+template<InNeighborGraph G>
+bool BidirectionalBfs<G>::search(int source, int target) {
+    const int n = graph.get_number_of_vertices();
+    best = -1;
+    if (source < 0 || source >= n || target < 0 || target >= n) return false;
+
+    if (++epoch == 0) {
+        //* the counter wrapped around, old stamps could look current
+        std::fill(forward.seen.begin(), forward.seen.end(), 0);
+        std::fill(backward.seen.begin(), backward.seen.end(), 0);
+        epoch = 1;
+    }
+    touched.clear();
+    start(forward, source);
+    start(backward, target);
+    if (source == target) {
+        best = 0;
+        meet_forward = meet_backward = -1;
+        return true;
+    }
+
+    while (!forward.frontier.empty() && !backward.frontier.empty()) {
+        if (forward.frontier.size() <= backward.frontier.size()) {
+            expand<true>(forward, backward);
+        } else {
+            expand<false>(backward, forward);
+        }
+        if (best != -1) return true;
+    }
+    return false;
+}
+
+template<InNeighborGraph G>
+std::vector<int> BidirectionalBfs<G>::path(int source, int target) {
+    std::vector<int> vertices;
+    if (!search(source, target)) return vertices;
+    if (meet_forward == -1) {
+        vertices.push_back(source);
+        return vertices;
+    }
+
+    for (int v = meet_forward; v != -1; v = forward.parent[v]) vertices.push_back(v);
+    std::reverse(vertices.begin(), vertices.end());
+    for (int v = meet_backward; v != -1; v = backward.parent[v]) vertices.push_back(v);
+    return vertices;
+}
+
+//! liczba krawędzi najkrótszej ścieżki z source do target (BidirectionalBfs), -1 gdy jej nie ma
+template<InNeighborGraph G>
+int bidirectional_distance(const G& graph, const int source, const int target) {
+    return BidirectionalBfs<G>(graph).distance(source, target);
+}
+
+int bidirectional_distance(const Graph& graph, const int source, const int target) {
+    return bidirectional_distance(VirtualGraph(graph), source, target);
+}
+#endif
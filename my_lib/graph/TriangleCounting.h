@@ -0,0 +1,313 @@
+#ifndef TRIANGLE_COUNTING_H
+#define TRIANGLE_COUNTING_H
+
+#include "../../include/SDL2/SDL_cpuinfo.h"
+#include "Graph.h"
+#include "GraphConcept.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TRIANGLE_COUNTING_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TRIANGLE_COUNTING_TARGET(isa) __attribute__((target(isa)))
+#else
+#define TRIANGLE_COUNTING_TARGET(isa)
+#endif
+
+struct TriangleCounts {
+    long long triangles = 0;                 //* triangles of the graph without directions and self-loops
+    long long cycles = 0;                    //* directed 3-cycles u -> v -> w -> u, each counted once
+    long long transitive = 0;                //* ordered triples x -> y, y -> z, x -> z (triad 030T and the like)
+    std::vector<long long> local_triangles;  //* triangles through every vertex, when requested
+    std::vector<long long> local_cycles;     //* directed 3-cycles through every vertex, when requested
+};
+
+/**
+ * @brief Triangle and triad counting on degree-ordered adjacency arrays.
+ * @note Vertices are renumbered by (undirected degree, id) and every pair {u, v} joined by an edge
+ * @note in either direction is stored once, in the row of the lower vertex; the two low bits of
+ * @note an entry tell which directions exist. A triangle a < b < c is found once, as an element c
+ * @note of row(a) after b intersected with row(b); no row is longer than sqrt(2m), so the whole
+ * @note count is O(m^1.5).
+ * @note The intersection compares a block of 8 (AVX2) or 4 (SSE2) entries with every entry of
+ * @note the other block at once; the rare matches are classified afterwards, by a table lookup
+ * @note on the direction bits of the three edges.
+ * @note Rows are handed out in chunks by parallel_for; per-chunk totals are summed at the end,
+ * @note local counts are added with relaxed atomics.
+ */
+class TriangleCounter {
+    public:
+        enum class Kernel { SCALAR, SSE2, AVX2 };
+
+        TriangleCounter(int threads = default_thread_count(), Kernel kernel = detect_kernel())
+            : threads(threads), kernel(kernel) {}
+
+        static Kernel detect_kernel();
+
+        template<OutNeighborGraph G>
+        TriangleCounts count(const G& graph, bool local = false);
+        TriangleCounts count(const Graph& graph, bool local = false) { return count(VirtualGraph(graph), local);}
+
+    private:
+        static constexpr int CHUNK = 64;
+        static constexpr uint32_t FORWARD = 1;   // krawędź niższy -> wyższy istnieje w grafie
+        static constexpr uint32_t BACKWARD = 2;  // krawędź wyższy -> niższy istnieje w grafie
+
+        int threads;
+        Kernel kernel;
+        std::vector<int> offsets;
+        std::vector<uint32_t> entries;   // (numer w porządku stopni << 2) | kierunki
+        std::vector<int> original;       // numer wierzchołka w grafie dla numeru w porządku
+
+        //* totals of one chunk of rows
+        struct Partial {
+            long long triangles = 0;
+            long long cycles = 0;
+            long long transitive = 0;
+        };
+
+        static constexpr std::array<uint8_t, 64> triad_table();
+
+        template<OutNeighborGraph G>
+        void build(const G& graph);
+        void classify(int a, int b, uint32_t ab, uint32_t ac, uint32_t bc, Partial& partial, TriangleCounts *local) const;
+        void intersect(int a, int b, uint32_t ab, const uint32_t *x, int nx, const uint32_t *y, int ny,
+                uint32_t *matches, Partial& partial, TriangleCounts *local) const;
+#ifdef TRIANGLE_COUNTING_X86
+        static int intersect_sse2(const uint32_t *x, int nx, const uint32_t *y, int ny, int& i, int& j, uint32_t *matches);
+        static int intersect_avx2(const uint32_t *x, int nx, const uint32_t *y, int ny, int& i, int& j, uint32_t *matches);
+#endif
+};
+
+TriangleCounter::Kernel TriangleCounter::detect_kernel() {
+#ifdef TRIANGLE_COUNTING_X86
+    if (SDL_HasAVX2()) return Kernel::AVX2;
+    if (SDL_HasSSE2()) return Kernel::SSE2;
+#endif
+    return Kernel::SCALAR;
+}
+
+template<OutNeighborGraph G>
+void TriangleCounter::build(const G& graph) {
+    const int n = graph.get_number_of_vertices();
+
+    std::vector<int> degree(n, 0);
+    for (int u = 0; u < n; u++) {
+        graph.for_each_out_neighbor(u, [&](int v, int) {
+            if (u == v) return;
+            degree[u]++;
+            degree[v]++;
+        });
+    }
+    original.resize(n);
+    std::iota(original.begin(), original.end(), 0);
+    std::sort(original.begin(), original.end(), [&degree](int a, int b) {
+        return degree[a] != degree[b] ? degree[a] < degree[b] : a < b;
+    });
+    std::vector<int> rank(n);
+    for (int r = 0; r < n; r++) rank[original[r]] = r;
+
+    //* every edge goes to the row of its lower end, with the bit of its direction
+    offsets.assign(n + 1, 0);
+    for (int u = 0; u < n; u++) {
+        graph.for_each_out_neighbor(u, [&](int v, int) {
+            if (u != v) offsets[std::min(rank[u], rank[v]) + 1]++;
+        });
+    }
+    for (int r = 0; r < n; r++) offsets[r + 1] += offsets[r];
+    entries.assign(offsets[n], 0);
+    std::vector<int> next(offsets.begin(), offsets.end() - 1);
+    for (int u = 0; u < n; u++) {
+        graph.for_each_out_neighbor(u, [&](int v, int) {
+            if (u == v) return;
+            const int low = std::min(rank[u], rank[v]);
+            const int high = std::max(rank[u], rank[v]);
+            entries[next[low]++] = (static_cast<uint32_t>(high) << 2) | (rank[u] < rank[v] ? FORWARD : BACKWARD);
+        });
+    }
+
+    //* rows sorted by target, u -> v and v -> u merged into one entry
+    int written = 0;
+    for (int r = 0; r < n; r++) {
+        const int begin = offsets[r];
+        std::sort(entries.begin() + begin, entries.begin() + offsets[r + 1]);
+        offsets[r] = written;
+        for (int i = begin; i < offsets[r + 1]; i++) {
+            if (written > offsets[r] && (entries[written - 1] >> 2) == (entries[i] >> 2)) {
+                entries[written - 1] |= entries[i] & 3;
+            } else {
+                entries[written++] = entries[i];
+            }
+        }
+    }
+    offsets[n] = written;
+    entries.resize(written);
+}
+
+//* number of 3-cycles (bits 0-1) and transitive triads (bits 2-4) of a triangle, by its direction bits
+constexpr std::array<uint8_t, 64> TriangleCounter::triad_table() {
+    std::array<uint8_t, 64> table{};
+    for (int code = 0; code < 64; code++) {
+        //* edge p -> q among the vertices 0 < 1 < 2 of the triangle
+        auto has = [code](int p, int q) -> bool {
+            const int pair = (p + q == 1) ? 0 : (p + q == 2) ? 2 : 4;  // {0,1}, {0,2}, {1,2}
+            return (code >> pair) & (p < q ? FORWARD : BACKWARD);
+        };
+        const int cycles = (has(0, 1) && has(1, 2) && has(2, 0)) + (has(0, 2) && has(2, 1) && has(1, 0));
+        int transitive = 0;
+        const int orders[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+        for (const auto& o : orders) transitive += has(o[0], o[1]) && has(o[1], o[2]) && has(o[0], o[2]);
+        table[code] = static_cast<uint8_t>(cycles | transitive << 2);
+    }
+    return table;
+}
+
+/**
+ * @brief One triangle a < b < c, given the entries of {a, b}, {a, c} and {b, c}.
+ */
+void TriangleCounter::classify(int a, int b, uint32_t ab, uint32_t ac, uint32_t bc, Partial& partial, TriangleCounts *local) const {
+    static constexpr std::array<uint8_t, 64> TRIADS = triad_table();
+    const int triads = TRIADS[(ab & 3) | (ac & 3) << 2 | (bc & 3) << 4];
+    partial.triangles++;
+    partial.cycles += triads & 3;
+    partial.transitive += triads >> 2;
+
+    if (local) {
+        for (int r : {a, b, static_cast<int>(ac >> 2)}) {
+            const int v = original[r];
+            std::atomic_ref<long long>(local->local_triangles[v]).fetch_add(1, std::memory_order_relaxed);
+            if (triads & 3) std::atomic_ref<long long>(local->local_cycles[v]).fetch_add(triads & 3, std::memory_order_relaxed);
+        }
+    }
+}
+
+#ifdef TRIANGLE_COUNTING_X86
+/**
+ * @brief Blocks of 4: x[i..i+4) against every element of y[j..j+4), until one of the lists ends.
+ * @note Writes the matching pairs of entries to matches and returns their number; classifying
+ * @note them here would call out of the SIMD code for every triangle.
+ */
+TRIANGLE_COUNTING_TARGET("sse2")
+int TriangleCounter::intersect_sse2(const uint32_t *x, int nx, const uint32_t *y, int ny, int& i, int& j, uint32_t *matches) {
+    int found_count = 0;
+    while (i + 4 <= nx && j + 4 <= ny) {
+        const __m128i xv = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)), 2);
+        __m128i found[4];
+        for (int k = 0; k < 4; k++) found[k] = _mm_cmpeq_epi32(xv, _mm_set1_epi32(static_cast<int>(y[j + k] >> 2)));
+        const __m128i any = _mm_or_si128(_mm_or_si128(found[0], found[1]), _mm_or_si128(found[2], found[3]));
+        if (_mm_movemask_epi8(any)) {
+            for (int k = 0; k < 4; k++) {
+                for (int mask = _mm_movemask_ps(_mm_castsi128_ps(found[k])); mask; mask &= mask - 1) {
+                    matches[found_count++] = x[i + __builtin_ctz(mask)];
+                    matches[found_count++] = y[j + k];
+                }
+            }
+        }
+        const uint32_t x_last = x[i + 3] >> 2, y_last = y[j + 3] >> 2;
+        if (x_last <= y_last) i += 4;
+        if (y_last <= x_last) j += 4;
+    }
+    return found_count / 2;
+}
+
+TRIANGLE_COUNTING_TARGET("avx2")
+int TriangleCounter::intersect_avx2(const uint32_t *x, int nx, const uint32_t *y, int ny, int& i, int& j, uint32_t *matches) {
+    int found_count = 0;
+    while (i + 8 <= nx && j + 8 <= ny) {
+        const __m256i xv = _mm256_srli_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)), 2);
+        __m256i found[8];
+        for (int k = 0; k < 8; k++) found[k] = _mm256_cmpeq_epi32(xv, _mm256_set1_epi32(static_cast<int>(y[j + k] >> 2)));
+        const __m256i any = _mm256_or_si256(
+                _mm256_or_si256(_mm256_or_si256(found[0], found[1]), _mm256_or_si256(found[2], found[3])),
+                _mm256_or_si256(_mm256_or_si256(found[4], found[5]), _mm256_or_si256(found[6], found[7])));
+        if (!_mm256_testz_si256(any, any)) {
+            for (int k = 0; k < 8; k++) {
+                for (int mask = _mm256_movemask_ps(_mm256_castsi256_ps(found[k])); mask; mask &= mask - 1) {
+                    matches[found_count++] = x[i + __builtin_ctz(mask)];
+                    matches[found_count++] = y[j + k];
+                }
+            }
+        }
+        const uint32_t x_last = x[i + 7] >> 2, y_last = y[j + 7] >> 2;
+        if (x_last <= y_last) i += 8;
+        if (y_last <= x_last) j += 8;
+    }
+    return found_count / 2;
+}
+#endif
+
+//* x - rest of row(a) after b, y - row(b); both sorted by target, matches holds 2 * min(nx, ny) entries
+void TriangleCounter::intersect(int a, int b, uint32_t ab, const uint32_t *x, int nx, const uint32_t *y, int ny,
+        uint32_t *matches, Partial& partial, TriangleCounts *local) const {
+    int i = 0, j = 0, found = 0;
+#ifdef TRIANGLE_COUNTING_X86
+    if (kernel == Kernel::AVX2) found = intersect_avx2(x, nx, y, ny, i, j, matches);
+    if (kernel == Kernel::SSE2) found = intersect_sse2(x, nx, y, ny, i, j, matches);
+#endif
+    for (int k = 0; k < found; k++) classify(a, b, ab, matches[2 * k], matches[2 * k + 1], partial, local);
+    while (i < nx && j < ny) {
+        const uint32_t p = x[i] >> 2, q = y[j] >> 2;
+        if (p == q) classify(a, b, ab, x[i], y[j], partial, local);
+        if (p <= q) i++;
+        if (q <= p) j++;
+    }
+}
+
+template<OutNeighborGraph G>
+TriangleCounts TriangleCounter::count(const G& graph, bool local) {
+    build(graph);
+    const int n = graph.get_number_of_vertices();
+
+    TriangleCounts result;
+    if (local) {
+        result.local_triangles.assign(n, 0);
+        result.local_cycles.assign(n, 0);
+    }
+    TriangleCounts *locals = local ? &result : nullptr;
+
+    int longest = 0;
+    for (int a = 0; a < n; a++) longest = std::max(longest, offsets[a + 1] - offsets[a]);
+
+    const int chunks = (n + CHUNK - 1) / CHUNK;
+    std::vector<Partial> partials(chunks);
+    parallel_for(0, chunks, [&](int chunk) {
+        std::vector<uint32_t> matches(2 * static_cast<size_t>(longest));
+        Partial partial;
+        const int end = std::min(n, (chunk + 1) * CHUNK);
+        for (int a = chunk * CHUNK; a < end; a++) {
+            for (int e = offsets[a]; e < offsets[a + 1]; e++) {
+                const int b = static_cast<int>(entries[e] >> 2);
+                intersect(a, b, entries[e], entries.data() + e + 1, offsets[a + 1] - e - 1,
+                        entries.data() + offsets[b], offsets[b + 1] - offsets[b], matches.data(), partial, locals);
+            }
+        }
+        partials[chunk] = partial;
+    }, threads);
+
+    for (const Partial& partial : partials) {
+        result.triangles += partial.triangles;
+        result.cycles += partial.cycles;
+        result.transitive += partial.transitive;
+    }
+    return result;
+}
+
+//! liczby trójkątów, 3-cykli i triad przechodnich, patrz TriangleCounter
+template<OutNeighborGraph G>
+TriangleCounts count_triangles(const G& graph, bool local = false) {
+    return TriangleCounter().count(graph, local);
+}
+
+TriangleCounts count_triangles(const Graph& graph, bool local = false) {
+    return count_triangles(VirtualGraph(graph), local);
+}
+#endif
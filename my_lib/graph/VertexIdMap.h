@@ -0,0 +1,99 @@
+#ifndef VERTEX_ID_MAP_H
+#define VERTEX_ID_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Maps arbitrary 64-bit vertex ids (e.g. account numbers) to dense ids 0..k-1
+ * in order of first appearance, and back.
+ * @note Open addressing with linear probing: keys and dense ids live in two flat arrays
+ * @note with a power-of-two size kept at most half full, so a lookup is usually one cache miss.
+ * @note The reverse mapping is a plain vector indexed by the dense id.
+ */
+class VertexIdMap {
+    public:
+        VertexIdMap(size_t expected = 0) { reserve(expected);}
+
+        int size() const { return static_cast<int>(originals.size());}
+
+        void reserve(size_t expected) {
+            size_t capacity = 16;
+            while (capacity < 2 * expected) capacity *= 2;
+            if (capacity > keys.size()) rehash(capacity);
+            originals.reserve(expected);
+        }
+
+        void clear() {
+            keys.clear();
+            values.clear();
+            originals.clear();
+            mask = 0;
+            shift = 64;
+        }
+
+        //! zwraca gęsty indeks wierzchołka, dodając go, jeśli jeszcze go nie ma
+        int insert(uint64_t id) {
+            if (2 * (originals.size() + 1) > keys.size()) rehash(keys.empty() ? 16 : 2 * keys.size());
+
+            size_t slot = home(id);
+            while (values[slot] != EMPTY) {
+                if (keys[slot] == id) return values[slot];
+                slot = (slot + 1) & mask;
+            }
+
+            const int dense = static_cast<int>(originals.size());
+            keys[slot] = id;
+            values[slot] = dense;
+            originals.push_back(id);
+            return dense;
+        }
+
+        //! zwraca gęsty indeks albo -1, jeśli wierzchołka nie ma w mapie
+        int find(uint64_t id) const {
+            if (keys.empty()) return EMPTY;
+
+            size_t slot = home(id);
+            while (values[slot] != EMPTY) {
+                if (keys[slot] == id) return values[slot];
+                slot = (slot + 1) & mask;
+            }
+            return EMPTY;
+        }
+
+        bool contains(uint64_t id) const { return find(id) != EMPTY;}
+
+        uint64_t original(int dense) const { return originals[dense];} //* original id of a dense id
+        const std::vector<uint64_t>& get_originals() const { return originals;}
+
+    private:
+        static constexpr int EMPTY = -1;
+
+        std::vector<uint64_t> keys;
+        std::vector<int> values;       // EMPTY oznacza wolne miejsce
+        std::vector<uint64_t> originals;
+        size_t mask = 0;
+        int shift = 64;
+
+        //* Fibonacci hashing: the top bits of id * 2^64/phi, also for sequential ids
+        size_t home(uint64_t id) const {
+            return static_cast<size_t>((id * 0x9E3779B97F4A7C15ULL) >> shift) & mask;
+        }
+
+        void rehash(size_t capacity) {
+            keys.assign(capacity, 0);
+            values.assign(capacity, EMPTY);
+            mask = capacity - 1;
+            shift = 64;
+            for (size_t c = capacity; c > 1; c >>= 1) shift--;
+
+            for (size_t dense = 0; dense < originals.size(); dense++) {
+                size_t slot = home(originals[dense]);
+                while (values[slot] != EMPTY) slot = (slot + 1) & mask;
+                keys[slot] = originals[dense];
+                values[slot] = static_cast<int>(dense);
+            }
+        }
+};
+#endif